@@ -0,0 +1,147 @@
+/*
+ * ChaCha20 256-bit cipher algorithm, RFC7539, ARM NEON functions
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The single block function keeps one state row per Q register and
+ * (un)diagonalizes the rows with vext between column and diagonal rounds.
+ * The four block function keeps each state word of four consecutive blocks
+ * in one Q register, and only needs to transpose the result when xoring it
+ * into the output.
+ */
+
+#include <crypto/chacha20.h>
+#include <linux/types.h>
+#include <arm_neon.h>
+
+#ifndef __ARM_NEON__
+#error You should compile this file with '-mfloat-abi=softfp -mfpu=neon'
+#endif
+
+#define ROTL(x, n)	vsriq_n_u32(vshlq_n_u32(x, n), x, 32 - (n))
+
+/*
+ * The keystream is serialized little endian: byte lane 0 of a register
+ * holds the least significant byte of word 0 regardless of endianness.
+ */
+static inline void xor_store(u8 *dst, const u8 *src, uint32x4_t x)
+{
+	vst1q_u8(dst, veorq_u8(vld1q_u8(src), vreinterpretq_u8_u32(x)));
+}
+
+void chacha20_block_xor_neon(const u32 *state, u8 *dst, const u8 *src)
+{
+	const uint32x4_t s0 = vld1q_u32(state + 0);
+	const uint32x4_t s1 = vld1q_u32(state + 4);
+	const uint32x4_t s2 = vld1q_u32(state + 8);
+	const uint32x4_t s3 = vld1q_u32(state + 12);
+	uint32x4_t x0 = s0, x1 = s1, x2 = s2, x3 = s3;
+	int i;
+
+	for (i = 0; i < 10; i++) {
+		x0 = vaddq_u32(x0, x1); x3 = veorq_u32(x3, x0);
+		x3 = vreinterpretq_u32_u16(vrev32q_u16(vreinterpretq_u16_u32(x3)));
+		x2 = vaddq_u32(x2, x3); x1 = veorq_u32(x1, x2); x1 = ROTL(x1, 12);
+		x0 = vaddq_u32(x0, x1); x3 = veorq_u32(x3, x0); x3 = ROTL(x3, 8);
+		x2 = vaddq_u32(x2, x3); x1 = veorq_u32(x1, x2); x1 = ROTL(x1, 7);
+
+		x1 = vextq_u32(x1, x1, 1);
+		x2 = vextq_u32(x2, x2, 2);
+		x3 = vextq_u32(x3, x3, 3);
+
+		x0 = vaddq_u32(x0, x1); x3 = veorq_u32(x3, x0);
+		x3 = vreinterpretq_u32_u16(vrev32q_u16(vreinterpretq_u16_u32(x3)));
+		x2 = vaddq_u32(x2, x3); x1 = veorq_u32(x1, x2); x1 = ROTL(x1, 12);
+		x0 = vaddq_u32(x0, x1); x3 = veorq_u32(x3, x0); x3 = ROTL(x3, 8);
+		x2 = vaddq_u32(x2, x3); x1 = veorq_u32(x1, x2); x1 = ROTL(x1, 7);
+
+		x1 = vextq_u32(x1, x1, 3);
+		x2 = vextq_u32(x2, x2, 2);
+		x3 = vextq_u32(x3, x3, 1);
+	}
+
+	xor_store(dst + 0, src + 0, vaddq_u32(x0, s0));
+	xor_store(dst + 16, src + 16, vaddq_u32(x1, s1));
+	xor_store(dst + 32, src + 32, vaddq_u32(x2, s2));
+	xor_store(dst + 48, src + 48, vaddq_u32(x3, s3));
+}
+
+#define QR(a, b, c, d)						\
+	do {							\
+		x[a] = vaddq_u32(x[a], x[b]);			\
+		x[d] = veorq_u32(x[d], x[a]);			\
+		x[d] = vreinterpretq_u32_u16(			\
+			vrev32q_u16(vreinterpretq_u16_u32(x[d])));\
+		x[c] = vaddq_u32(x[c], x[d]);			\
+		x[b] = veorq_u32(x[b], x[c]);			\
+		x[b] = ROTL(x[b], 12);				\
+		x[a] = vaddq_u32(x[a], x[b]);			\
+		x[d] = veorq_u32(x[d], x[a]);			\
+		x[d] = ROTL(x[d], 8);				\
+		x[c] = vaddq_u32(x[c], x[d]);			\
+		x[b] = veorq_u32(x[b], x[c]);			\
+		x[b] = ROTL(x[b], 7);				\
+	} while (0)
+
+/*
+ * Transpose four state words of four blocks and xor them into the 16 byte
+ * chunk at offset 'off' of each of the four output blocks.
+ */
+static inline void xor_transpose4(u8 *dst, const u8 *src, unsigned int off,
+				  uint32x4_t a, uint32x4_t b,
+				  uint32x4_t c, uint32x4_t d)
+{
+	uint32x4x2_t ab = vtrnq_u32(a, b);
+	uint32x4x2_t cd = vtrnq_u32(c, d);
+
+	off *= sizeof(u32);
+	xor_store(dst + 0 * CHACHA20_BLOCK_SIZE + off,
+		  src + 0 * CHACHA20_BLOCK_SIZE + off,
+		  vcombine_u32(vget_low_u32(ab.val[0]),
+			       vget_low_u32(cd.val[0])));
+	xor_store(dst + 1 * CHACHA20_BLOCK_SIZE + off,
+		  src + 1 * CHACHA20_BLOCK_SIZE + off,
+		  vcombine_u32(vget_low_u32(ab.val[1]),
+			       vget_low_u32(cd.val[1])));
+	xor_store(dst + 2 * CHACHA20_BLOCK_SIZE + off,
+		  src + 2 * CHACHA20_BLOCK_SIZE + off,
+		  vcombine_u32(vget_high_u32(ab.val[0]),
+			       vget_high_u32(cd.val[0])));
+	xor_store(dst + 3 * CHACHA20_BLOCK_SIZE + off,
+		  src + 3 * CHACHA20_BLOCK_SIZE + off,
+		  vcombine_u32(vget_high_u32(ab.val[1]),
+			       vget_high_u32(cd.val[1])));
+}
+
+void chacha20_4block_xor_neon(const u32 *state, u8 *dst, const u8 *src)
+{
+	static const u32 ctrinc[4] = { 0, 1, 2, 3 };
+	uint32x4_t x[16];
+	int i;
+
+	for (i = 0; i < 16; i++)
+		x[i] = vdupq_n_u32(state[i]);
+	x[12] = vaddq_u32(x[12], vld1q_u32(ctrinc));
+
+	for (i = 0; i < 10; i++) {
+		QR(0, 4, 8, 12);
+		QR(1, 5, 9, 13);
+		QR(2, 6, 10, 14);
+		QR(3, 7, 11, 15);
+
+		QR(0, 5, 10, 15);
+		QR(1, 6, 11, 12);
+		QR(2, 7, 8, 13);
+		QR(3, 4, 9, 14);
+	}
+
+	for (i = 0; i < 16; i++)
+		x[i] = vaddq_u32(x[i], vdupq_n_u32(state[i]));
+	x[12] = vaddq_u32(x[12], vld1q_u32(ctrinc));
+
+	for (i = 0; i < 16; i += 4)
+		xor_transpose4(dst, src, i, x[i], x[i + 1], x[i + 2], x[i + 3]);
+}
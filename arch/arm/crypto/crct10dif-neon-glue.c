@@ -0,0 +1,127 @@
+/*
+ * Accelerated CRC-T10DIF using ARM NEON polynomial multiply instructions
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/crc-t10dif.h>
+#include <linux/init.h>
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/string.h>
+
+#include <crypto/internal/hash.h>
+
+#include <asm/crc-neon.h>
+#include <asm/hwcap.h>
+#include <asm/neon.h>
+#include <asm/simd.h>
+
+#define CRCT10DIF_NEON_MIN_LEN	256
+
+/* x^(D+64) mod P and x^D mod P for D = 512, 384, 256 and 128 */
+static const struct crc_fold_consts crct10dif_consts = { {
+	0xdd31, 0x1069, 0x4a84, 0x84da, 0x7acc, 0x857d, 0x1faa, 0xa010,
+} };
+
+struct chksum_desc_ctx {
+	__u16 crc;
+};
+
+static u16 crct10dif_neon(u16 crc, const u8 *data, unsigned int length)
+{
+	u8 buf[16] __aligned(8);
+
+	if (length < CRCT10DIF_NEON_MIN_LEN || !may_use_simd())
+		return crc_t10dif_generic(crc, data, length);
+
+	kernel_neon_begin();
+	crc_fold_neon_be(&crct10dif_consts, (u32)crc << 16, data, length, buf);
+	kernel_neon_end();
+
+	crc = crc_t10dif_generic(0, buf, sizeof(buf));
+	return crc_t10dif_generic(crc, data + round_down(length, 16),
+				  length % 16);
+}
+
+static int chksum_init(struct shash_desc *desc)
+{
+	struct chksum_desc_ctx *ctx = shash_desc_ctx(desc);
+
+	ctx->crc = 0;
+
+	return 0;
+}
+
+static int chksum_update(struct shash_desc *desc, const u8 *data,
+			 unsigned int length)
+{
+	struct chksum_desc_ctx *ctx = shash_desc_ctx(desc);
+
+	ctx->crc = crct10dif_neon(ctx->crc, data, length);
+	return 0;
+}
+
+static int chksum_final(struct shash_desc *desc, u8 *out)
+{
+	struct chksum_desc_ctx *ctx = shash_desc_ctx(desc);
+
+	*(__u16 *)out = ctx->crc;
+	return 0;
+}
+
+static int chksum_finup(struct shash_desc *desc, const u8 *data,
+			unsigned int len, u8 *out)
+{
+	struct chksum_desc_ctx *ctx = shash_desc_ctx(desc);
+
+	*(__u16 *)out = crct10dif_neon(ctx->crc, data, len);
+	return 0;
+}
+
+static int chksum_digest(struct shash_desc *desc, const u8 *data,
+			 unsigned int length, u8 *out)
+{
+	*(__u16 *)out = crct10dif_neon(0, data, length);
+	return 0;
+}
+
+static struct shash_alg alg = {
+	.digestsize		=	CRC_T10DIF_DIGEST_SIZE,
+	.init			=	chksum_init,
+	.update			=	chksum_update,
+	.final			=	chksum_final,
+	.finup			=	chksum_finup,
+	.digest			=	chksum_digest,
+	.descsize		=	sizeof(struct chksum_desc_ctx),
+	.base			=	{
+		.cra_name		=	"crct10dif",
+		.cra_driver_name	=	"crct10dif-neon",
+		.cra_priority		=	200,
+		.cra_blocksize		=	CRC_T10DIF_BLOCK_SIZE,
+		.cra_module		=	THIS_MODULE,
+	}
+};
+
+static int __init crct10dif_neon_mod_init(void)
+{
+	if (!cpu_has_neon())
+		return -ENODEV;
+
+	return crypto_register_shash(&alg);
+}
+
+static void __exit crct10dif_neon_mod_fini(void)
+{
+	crypto_unregister_shash(&alg);
+}
+
+module_init(crct10dif_neon_mod_init);
+module_exit(crct10dif_neon_mod_fini);
+
+MODULE_DESCRIPTION("T10 DIF CRC calculation accelerated with ARM NEON");
+MODULE_LICENSE("GPL");
+MODULE_ALIAS_CRYPTO("crct10dif");
+MODULE_ALIAS_CRYPTO("crct10dif-neon");
@@ -0,0 +1,162 @@
+/*
+ * Poly1305 authenticator algorithm, RFC7539, ARM NEON functions
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Two blocks are processed per iteration, one in each 64-bit lane: both
+ * lanes are multiplied by r^2, except for the last iteration where the
+ * second lane is multiplied by r only.  The lanes are then added up, which
+ * gives the same result as the sequential h = (h + m) * r evaluation.
+ */
+
+#include <crypto/poly1305.h>
+#include <linux/types.h>
+#include <arm_neon.h>
+
+#ifndef __ARM_NEON__
+#error You should compile this file with '-mfloat-abi=softfp -mfpu=neon'
+#endif
+
+static inline u32 le32(const u8 *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((u32)p[3] << 24);
+}
+
+static inline uint32x2_t lanes(u32 a, u32 b)
+{
+	return vset_lane_u32(b, vdup_n_u32(a), 1);
+}
+
+/*
+ * Process 'blocks' (a non-zero, even number of) 16 byte blocks from src
+ * into the 26-bit limb accumulator h, given r and r^2 in 26-bit limbs.
+ */
+void poly1305_2block_neon(u32 *h, const u32 *r, const u32 *r2,
+			  const u8 *src, unsigned int blocks, u32 hibit)
+{
+	const uint64x2_t mask = vdupq_n_u64(0x3ffffff);
+	const uint32x2_t hi = vdup_n_u32(hibit);
+	uint32x2_t a0, a1, a2, a3, a4;
+	uint32x2_t b0, b1, b2, b3, b4;
+	uint32x2_t s1, s2, s3, s4;
+	uint64x2_t d0, d1, d2, d3, d4, c;
+	u64 t0, t1, t2, t3, t4, t;
+
+	a0 = lanes(h[0], 0);
+	a1 = lanes(h[1], 0);
+	a2 = lanes(h[2], 0);
+	a3 = lanes(h[3], 0);
+	a4 = lanes(h[4], 0);
+
+	b0 = vdup_n_u32(r2[0]);
+	b1 = vdup_n_u32(r2[1]);
+	b2 = vdup_n_u32(r2[2]);
+	b3 = vdup_n_u32(r2[3]);
+	b4 = vdup_n_u32(r2[4]);
+
+	for (;;) {
+		const u8 *m0 = src, *m1 = src + POLY1305_BLOCK_SIZE;
+
+		/* a += m */
+		a0 = vadd_u32(a0, lanes(le32(m0 + 0) & 0x3ffffff,
+					le32(m1 + 0) & 0x3ffffff));
+		a1 = vadd_u32(a1, lanes((le32(m0 + 3) >> 2) & 0x3ffffff,
+					(le32(m1 + 3) >> 2) & 0x3ffffff));
+		a2 = vadd_u32(a2, lanes((le32(m0 + 6) >> 4) & 0x3ffffff,
+					(le32(m1 + 6) >> 4) & 0x3ffffff));
+		a3 = vadd_u32(a3, lanes((le32(m0 + 9) >> 6) & 0x3ffffff,
+					(le32(m1 + 9) >> 6) & 0x3ffffff));
+		a4 = vadd_u32(a4, vorr_u32(lanes(le32(m0 + 12) >> 8,
+						 le32(m1 + 12) >> 8), hi));
+
+		src += 2 * POLY1305_BLOCK_SIZE;
+		blocks -= 2;
+
+		if (!blocks) {
+			/* last pair: multiply the second lane by r only */
+			b0 = vset_lane_u32(r[0], b0, 1);
+			b1 = vset_lane_u32(r[1], b1, 1);
+			b2 = vset_lane_u32(r[2], b2, 1);
+			b3 = vset_lane_u32(r[3], b3, 1);
+			b4 = vset_lane_u32(r[4], b4, 1);
+		}
+
+		s1 = vmul_n_u32(b1, 5);
+		s2 = vmul_n_u32(b2, 5);
+		s3 = vmul_n_u32(b3, 5);
+		s4 = vmul_n_u32(b4, 5);
+
+		/* d = a * b */
+		d0 = vmull_u32(a0, b0);
+		d0 = vmlal_u32(d0, a1, s4);
+		d0 = vmlal_u32(d0, a2, s3);
+		d0 = vmlal_u32(d0, a3, s2);
+		d0 = vmlal_u32(d0, a4, s1);
+
+		d1 = vmull_u32(a0, b1);
+		d1 = vmlal_u32(d1, a1, b0);
+		d1 = vmlal_u32(d1, a2, s4);
+		d1 = vmlal_u32(d1, a3, s3);
+		d1 = vmlal_u32(d1, a4, s2);
+
+		d2 = vmull_u32(a0, b2);
+		d2 = vmlal_u32(d2, a1, b1);
+		d2 = vmlal_u32(d2, a2, b0);
+		d2 = vmlal_u32(d2, a3, s4);
+		d2 = vmlal_u32(d2, a4, s3);
+
+		d3 = vmull_u32(a0, b3);
+		d3 = vmlal_u32(d3, a1, b2);
+		d3 = vmlal_u32(d3, a2, b1);
+		d3 = vmlal_u32(d3, a3, b0);
+		d3 = vmlal_u32(d3, a4, s4);
+
+		d4 = vmull_u32(a0, b4);
+		d4 = vmlal_u32(d4, a1, b3);
+		d4 = vmlal_u32(d4, a2, b2);
+		d4 = vmlal_u32(d4, a3, b1);
+		d4 = vmlal_u32(d4, a4, b0);
+
+		if (!blocks)
+			break;
+
+		/* partial reduction of both lanes */
+		c = vshrq_n_u64(d0, 26); d0 = vandq_u64(d0, mask);
+		d1 = vaddq_u64(d1, c);
+		c = vshrq_n_u64(d1, 26); d1 = vandq_u64(d1, mask);
+		d2 = vaddq_u64(d2, c);
+		c = vshrq_n_u64(d2, 26); d2 = vandq_u64(d2, mask);
+		d3 = vaddq_u64(d3, c);
+		c = vshrq_n_u64(d3, 26); d3 = vandq_u64(d3, mask);
+		d4 = vaddq_u64(d4, c);
+		c = vshrq_n_u64(d4, 26); d4 = vandq_u64(d4, mask);
+		d0 = vaddq_u64(d0, vaddq_u64(c, vshlq_n_u64(c, 2)));
+		c = vshrq_n_u64(d0, 26); d0 = vandq_u64(d0, mask);
+		d1 = vaddq_u64(d1, c);
+
+		a0 = vmovn_u64(d0);
+		a1 = vmovn_u64(d1);
+		a2 = vmovn_u64(d2);
+		a3 = vmovn_u64(d3);
+		a4 = vmovn_u64(d4);
+	}
+
+	/* h = lane 0 + lane 1, fully carried */
+	t0 = vgetq_lane_u64(d0, 0) + vgetq_lane_u64(d0, 1);
+	t1 = vgetq_lane_u64(d1, 0) + vgetq_lane_u64(d1, 1);
+	t2 = vgetq_lane_u64(d2, 0) + vgetq_lane_u64(d2, 1);
+	t3 = vgetq_lane_u64(d3, 0) + vgetq_lane_u64(d3, 1);
+	t4 = vgetq_lane_u64(d4, 0) + vgetq_lane_u64(d4, 1);
+
+	t = t0 >> 26; h[0] = t0 & 0x3ffffff;
+	t1 += t;      t = t1 >> 26; h[1] = t1 & 0x3ffffff;
+	t2 += t;      t = t2 >> 26; h[2] = t2 & 0x3ffffff;
+	t3 += t;      t = t3 >> 26; h[3] = t3 & 0x3ffffff;
+	t4 += t;      t = t4 >> 26; h[4] = t4 & 0x3ffffff;
+	t = h[0] + t * 5;
+	h[0] = t & 0x3ffffff;
+	h[1] += t >> 26;
+}
@@ -0,0 +1,134 @@
+/*
+ * SHA-256 of four independent messages in parallel using NEON
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * Each 32-bit lane of a Q register carries the corresponding word of a
+ * different message, so all of the SHA-256 round logic maps directly onto
+ * NEON operations and no lane ever needs to talk to another.  The only
+ * shuffling required is the transpose of the message words on load.
+ */
+
+#include <linux/types.h>
+#include <arm_neon.h>
+
+#include "sha256_mb.h"
+
+#ifndef __ARM_NEON__
+#error You should compile this file with '-mfloat-abi=softfp -mfpu=neon'
+#endif
+
+static const u32 sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+	0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+	0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+	0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+	0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+	0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#define ROR(x, n)	vsriq_n_u32(vshlq_n_u32(x, 32 - (n)), x, n)
+
+#define S0(x)	veorq_u32(veorq_u32(ROR(x, 2), ROR(x, 13)), ROR(x, 22))
+#define S1(x)	veorq_u32(veorq_u32(ROR(x, 6), ROR(x, 11)), ROR(x, 25))
+#define s0(x)	veorq_u32(veorq_u32(ROR(x, 7), ROR(x, 18)), vshrq_n_u32(x, 3))
+#define s1(x)	veorq_u32(veorq_u32(ROR(x, 17), ROR(x, 19)), vshrq_n_u32(x, 10))
+
+/* load 16 bytes of big endian message words */
+static inline uint32x4_t load_be32(const u8 *p)
+{
+	return vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(p)));
+}
+
+/*
+ * Load words 4*i .. 4*i+3 of all four messages, so that w[4*i+j] ends up
+ * holding word 4*i+j of message l in lane l.
+ */
+static inline void load_words(uint32x4_t *w, const u8 * const src[], int i)
+{
+	uint32x4x2_t t0 = vtrnq_u32(load_be32(src[0] + 16 * i),
+				    load_be32(src[1] + 16 * i));
+	uint32x4x2_t t1 = vtrnq_u32(load_be32(src[2] + 16 * i),
+				    load_be32(src[3] + 16 * i));
+
+	w[4 * i + 0] = vcombine_u32(vget_low_u32(t0.val[0]),
+				    vget_low_u32(t1.val[0]));
+	w[4 * i + 1] = vcombine_u32(vget_low_u32(t0.val[1]),
+				    vget_low_u32(t1.val[1]));
+	w[4 * i + 2] = vcombine_u32(vget_high_u32(t0.val[0]),
+				    vget_high_u32(t1.val[0]));
+	w[4 * i + 3] = vcombine_u32(vget_high_u32(t0.val[1]),
+				    vget_high_u32(t1.val[1]));
+}
+
+void sha256_mb_neon_blocks(u32 *state, const u8 *src[SHA256_MB_LANES],
+			   unsigned int blocks)
+{
+	uint32x4_t s[8], w[16];
+	int i, t;
+
+	for (i = 0; i < 8; i++)
+		s[i] = vld1q_u32(state + SHA256_MB_LANES * i);
+
+	while (blocks--) {
+		uint32x4_t a = s[0], b = s[1], c = s[2], d = s[3];
+		uint32x4_t e = s[4], f = s[5], g = s[6], h = s[7];
+
+		for (i = 0; i < 4; i++)
+			load_words(w, src, i);
+
+		for (t = 0; t < 64; t++) {
+			uint32x4_t t1, t2;
+
+			if (t >= 16)
+				w[t & 15] = vaddq_u32(
+					vaddq_u32(w[t & 15], s1(w[(t - 2) & 15])),
+					vaddq_u32(w[(t - 7) & 15],
+						  s0(w[(t - 15) & 15])));
+
+			/* Ch(e, f, g) is a bit select of f and g by e */
+			t1 = vaddq_u32(vaddq_u32(h, S1(e)), vbslq_u32(e, f, g));
+			t1 = vaddq_u32(t1, vaddq_u32(vdupq_n_u32(sha256_k[t]),
+						     w[t & 15]));
+			/* Maj(a, b, c) is c where a and b differ, b elsewhere */
+			t2 = vaddq_u32(S0(a), vbslq_u32(veorq_u32(a, b), c, b));
+
+			h = g;
+			g = f;
+			f = e;
+			e = vaddq_u32(d, t1);
+			d = c;
+			c = b;
+			b = a;
+			a = vaddq_u32(t1, t2);
+		}
+
+		s[0] = vaddq_u32(s[0], a);
+		s[1] = vaddq_u32(s[1], b);
+		s[2] = vaddq_u32(s[2], c);
+		s[3] = vaddq_u32(s[3], d);
+		s[4] = vaddq_u32(s[4], e);
+		s[5] = vaddq_u32(s[5], f);
+		s[6] = vaddq_u32(s[6], g);
+		s[7] = vaddq_u32(s[7], h);
+
+		for (i = 0; i < SHA256_MB_LANES; i++)
+			src[i] += SHA256_BLOCK_SIZE;
+	}
+
+	for (i = 0; i < 8; i++)
+		vst1q_u32(state + SHA256_MB_LANES * i, s[i]);
+}
@@ -0,0 +1,17 @@
+#ifndef _CRYPTO_SHA256_MB_H
+#define _CRYPTO_SHA256_MB_H
+
+#include <crypto/sha.h>
+
+#define SHA256_MB_LANES		4
+
+/*
+ * Run 'blocks' SHA-256 blocks for each of four independent messages.  The
+ * state is interleaved: word i of the state of lane l is at
+ * state[SHA256_MB_LANES * i + l].  The source pointers are advanced past
+ * the data consumed.
+ */
+void sha256_mb_neon_blocks(u32 *state, const u8 *src[SHA256_MB_LANES],
+			   unsigned int blocks);
+
+#endif /* _CRYPTO_SHA256_MB_H */
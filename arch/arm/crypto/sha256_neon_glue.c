@@ -16,6 +16,7 @@
 
 #include <crypto/internal/hash.h>
 #include <linux/cryptohash.h>
+#include <linux/kernel.h>
 #include <linux/types.h>
 #include <linux/string.h>
 #include <crypto/sha.h>
@@ -23,8 +24,10 @@
 #include <asm/byteorder.h>
 #include <asm/simd.h>
 #include <asm/neon.h>
+#include <asm/unaligned.h>
 
 #include "sha256_glue.h"
+#include "sha256_mb.h"
 
 asmlinkage void sha256_block_data_order_neon(u32 *digest, const void *data,
 					     unsigned int num_blks);
@@ -68,13 +71,99 @@ static int sha256_final(struct shash_desc *desc, u8 *out)
 	return sha256_finup(desc, NULL, 0, out);
 }
 
+/*
+ * Finish up to SHA256_MB_LANES messages of the same length, all starting
+ * from the state in desc, in parallel.  Unused lanes duplicate lane 0.
+ */
+static int sha256_finup_mb(struct shash_desc *desc, const u8 * const data[],
+			   unsigned int len, u8 * const outs[],
+			   unsigned int num_msgs)
+{
+	struct sha256_state *sctx = shash_desc_ctx(desc);
+	unsigned int digest_words = crypto_shash_digestsize(desc->tfm) / 4;
+	unsigned int partial = sctx->count % SHA256_BLOCK_SIZE;
+	__be64 bits = cpu_to_be64((sctx->count + len) << 3);
+	u32 state[8 * SHA256_MB_LANES] __aligned(16);
+	u8 tail[SHA256_MB_LANES][2 * SHA256_BLOCK_SIZE] __aligned(8);
+	const u8 *src[SHA256_MB_LANES];
+	unsigned int done = 0, rem, blocks, i, l;
+
+	if (!may_use_simd()) {
+		for (i = 0; i < num_msgs; i++) {
+			SHASH_DESC_ON_STACK(desc2, desc->tfm);
+
+			desc2->tfm = desc->tfm;
+			desc2->flags = desc->flags;
+			memcpy(shash_desc_ctx(desc2), sctx, sizeof(*sctx));
+			crypto_sha256_arm_finup(desc2, data[i], len, outs[i]);
+		}
+		return 0;
+	}
+
+	for (i = 0; i < 8; i++)
+		for (l = 0; l < SHA256_MB_LANES; l++)
+			state[SHA256_MB_LANES * i + l] = sctx->state[i];
+
+	kernel_neon_begin();
+
+	/* complete the block left partially filled by the common prefix */
+	if (partial) {
+		done = min(len, SHA256_BLOCK_SIZE - partial);
+		for (l = 0; l < SHA256_MB_LANES; l++) {
+			memcpy(tail[l], sctx->buf, partial);
+			memcpy(tail[l] + partial, data[l < num_msgs ? l : 0],
+			       done);
+			src[l] = tail[l];
+		}
+		partial += done;
+		if (partial == SHA256_BLOCK_SIZE) {
+			sha256_mb_neon_blocks(state, src, 1);
+			partial = 0;
+		}
+	}
+
+	blocks = (len - done) / SHA256_BLOCK_SIZE;
+	if (blocks) {
+		for (l = 0; l < SHA256_MB_LANES; l++)
+			src[l] = data[l < num_msgs ? l : 0] + done;
+		sha256_mb_neon_blocks(state, src, blocks);
+		done += blocks * SHA256_BLOCK_SIZE;
+	}
+
+	/* pad with 0x80, zeroes and the message length in bits */
+	rem = partial ?: len - done;
+	blocks = rem + 1 + sizeof(bits) > SHA256_BLOCK_SIZE ? 2 : 1;
+	for (l = 0; l < SHA256_MB_LANES; l++) {
+		if (!partial)
+			memcpy(tail[l], data[l < num_msgs ? l : 0] + done, rem);
+		tail[l][rem] = 0x80;
+		memset(tail[l] + rem + 1, 0,
+		       blocks * SHA256_BLOCK_SIZE - rem - 1 - sizeof(bits));
+		memcpy(tail[l] + blocks * SHA256_BLOCK_SIZE - sizeof(bits),
+		       &bits, sizeof(bits));
+		src[l] = tail[l];
+	}
+	sha256_mb_neon_blocks(state, src, blocks);
+
+	kernel_neon_end();
+
+	for (l = 0; l < num_msgs; l++)
+		for (i = 0; i < digest_words; i++)
+			put_unaligned_be32(state[SHA256_MB_LANES * i + l],
+					   outs[l] + 4 * i);
+
+	return 0;
+}
+
 struct shash_alg sha256_neon_algs[] = { {
 	.digestsize	=	SHA256_DIGEST_SIZE,
 	.init		=	sha256_base_init,
 	.update		=	sha256_update,
 	.final		=	sha256_final,
 	.finup		=	sha256_finup,
+	.finup_mb	=	sha256_finup_mb,
 	.descsize	=	sizeof(struct sha256_state),
+	.mb_max_msgs	=	SHA256_MB_LANES,
 	.base		=	{
 		.cra_name	=	"sha256",
 		.cra_driver_name =	"sha256-neon",
@@ -89,7 +178,9 @@ struct shash_alg sha256_neon_algs[] = { {
 	.update		=	sha256_update,
 	.final		=	sha256_final,
 	.finup		=	sha256_finup,
+	.finup_mb	=	sha256_finup_mb,
 	.descsize	=	sizeof(struct sha256_state),
+	.mb_max_msgs	=	SHA256_MB_LANES,
 	.base		=	{
 		.cra_name	=	"sha224",
 		.cra_driver_name =	"sha224-neon",
@@ -0,0 +1,23 @@
+/*
+ * arch/arm/include/asm/copy-neon.h
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef __ASM_ARM_COPY_NEON_H
+#define __ASM_ARM_COPY_NEON_H
+
+#include <linux/types.h>
+
+#define COPY_NEON_BLOCK		64
+
+/*
+ * Copy len & ~(COPY_NEON_BLOCK - 1) bytes from src to dst, which must not
+ * overlap.  Must be called between kernel_neon_begin() and
+ * kernel_neon_end().
+ */
+void copy_neon(void *dst, const void *src, size_t len);
+
+#endif
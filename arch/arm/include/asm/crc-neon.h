@@ -0,0 +1,38 @@
+/*
+ * arch/arm/include/asm/crc-neon.h
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef __ASM_ARM_CRC_NEON_H
+#define __ASM_ARM_CRC_NEON_H
+
+#include <linux/types.h>
+
+#define CRC_FOLD_MIN_LEN	64
+
+/*
+ * Folding constants for one CRC polynomial P: one pair for each of the
+ * fold distances D = 512, 384, 256 and 128 bits.  For bit reflected CRCs
+ * the pair is bitrev64(x^(D+63) mod P), bitrev64(x^(D-1) mod P); for
+ * normal CRCs it is x^(D+64) mod P, x^D mod P.
+ */
+struct crc_fold_consts {
+	u64	k[8];
+};
+
+/*
+ * Fold len & ~15 bytes at p down to 16 bytes at out, which have the same
+ * CRC as the input when processed with a zero initial value.  crc is
+ * xored into the first four bytes of the input, in the byte order of the
+ * CRC.  len must be at least CRC_FOLD_MIN_LEN.  Must be called between
+ * kernel_neon_begin() and kernel_neon_end().
+ */
+void crc_fold_neon_le(const struct crc_fold_consts *c, u32 crc,
+		      const u8 *p, size_t len, u8 *out);
+void crc_fold_neon_be(const struct crc_fold_consts *c, u32 crc,
+		      const u8 *p, size_t len, u8 *out);
+
+#endif
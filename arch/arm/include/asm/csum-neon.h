@@ -0,0 +1,26 @@
+/*
+ * arch/arm/include/asm/csum-neon.h
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef __ASM_ARM_CSUM_NEON_H
+#define __ASM_ARM_CSUM_NEON_H
+
+#include <linux/types.h>
+
+#define CSUM_NEON_BLOCK		64
+
+/*
+ * Add up len & ~(CSUM_NEON_BLOCK - 1) bytes at src as native endian 32-bit
+ * words, without end around carry.  Folding the result down to 16 bits
+ * gives the same ones' complement sum as csum_partial().  The copy variant
+ * also stores the data to dst.  Must be called between kernel_neon_begin()
+ * and kernel_neon_end().
+ */
+u64 csum_partial_neon(const void *src, size_t len);
+u64 csum_partial_copy_neon(const void *src, void *dst, size_t len);
+
+#endif
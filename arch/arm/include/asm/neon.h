@@ -32,5 +32,23 @@
 
 #else
 void kernel_neon_begin(void);
+
+#ifdef CONFIG_KERNEL_MODE_NEON
+#include <linux/jump_label.h>
+#include <asm/simd.h>
+
+extern struct static_key kernel_neon_usable;
+
+/*
+ * For code with a scalar fallback: whether to process @len bytes with
+ * NEON, given that below @min_len kernel_neon_begin() costs more than
+ * NEON saves.  False until vfp_init() has found the NEON unit.
+ */
+static inline bool kernel_neon_ok(size_t len, size_t min_len)
+{
+	return static_key_false(&kernel_neon_usable) && len >= min_len &&
+	       may_use_simd();
+}
+#endif
 #endif
 void kernel_neon_end(void);
@@ -142,6 +142,16 @@ extern void __cpu_copy_user_highpage(struct page *to, struct page *from,
 #define clear_page(page)	memset((void *)(page), 0, PAGE_SIZE)
 extern void copy_page(void *to, const void *from);
 
+/*
+ * copy_page() using NEON where allowed, for callers in process context
+ * with a valid current thread, e.g. copying a page on a COW fault.
+ */
+#if defined(CONFIG_KERNEL_MODE_NEON) && defined(CONFIG_MMU)
+extern void copy_page_neon(void *to, const void *from);
+#else
+#define copy_page_neon(to, from)	copy_page(to, from)
+#endif
+
 #ifdef CONFIG_KUSER_HELPERS
 #define __HAVE_ARCH_GATE_AREA 1
 #endif
@@ -15,6 +15,11 @@ extern char * strchr(const char * s, int c);
 #define __HAVE_ARCH_MEMCPY
 extern void * memcpy(void *, const void *, __kernel_size_t);
 
+#if defined(CONFIG_KERNEL_MODE_NEON) && defined(CONFIG_MMU)
+#define __HAVE_ARCH_MEMCPY_LARGE
+extern void * memcpy_large(void *, const void *, __kernel_size_t);
+#endif
+
 #define __HAVE_ARCH_MEMMOVE
 extern void * memmove(void *, const void *, __kernel_size_t);
 
@@ -46,6 +46,13 @@ struct vdso_data {
 	u64 xtime_clock_snsec;	/* CLOCK_REALTIME sub-ns base */
 	u32 tz_minuteswest;	/* timezone info for gettimeofday(2) */
 	u32 tz_dsttime;
+
+	u32 btm_sec;		/* monotonic to boot time offset */
+	u32 btm_nsec;
+	u32 raw_time_sec;	/* CLOCK_MONOTONIC_RAW - seconds */
+	u32 raw_time_nsec;
+	u32 cs_raw_mult;	/* raw clocksource multiplier */
+	u32 hrtimer_res;	/* clock_getres(2) of the hrtimer clocks */
 };
 
 union vdso_data_store {
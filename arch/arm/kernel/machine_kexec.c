@@ -10,7 +10,10 @@
 #include <linux/irq.h>
 #include <linux/memblock.h>
 #include <asm/pgtable.h>
+#include <linux/libfdt.h>
+#include <linux/of.h>
 #include <linux/of_fdt.h>
+#include <linux/vmalloc.h>
 #include <asm/pgalloc.h>
 #include <asm/mmu_context.h>
 #include <asm/cacheflush.h>
@@ -35,6 +38,80 @@ static unsigned long dt_mem;
  * This prevents breakage of crash_notes attribute in kernel/ksysfs.c.
  */
 
+/*
+ * Regions preserved for the next kernel are only safe from it if the DTB
+ * we pass on reserves them, which is up to the kexec tools.  Warn about
+ * any it left out rather than fail: the data is simply lost in that case.
+ *
+ * Note that a zImage decompressor runs before the new kernel has seen the
+ * DTB and uses memory outside the kexec segments: the decompressed kernel
+ * below the zImage, its initial page tables, stack and heap.  Regions in
+ * the first few MB of RAM are overwritten by it no matter what the DTB
+ * says; kexec_preserve_region() users are expected to allocate theirs
+ * high in memory.
+ */
+static bool machine_kexec_fdt_reg_matches(const void *fdt, int node,
+					  struct kexec_preserved *region)
+{
+	int parent = fdt_parent_offset(fdt, node);
+	int addr_cells = 1, size_cells = 1, len;
+	const __be32 *prop;
+
+	if (parent < 0)
+		return false;
+
+	prop = fdt_getprop(fdt, parent, "#address-cells", NULL);
+	if (prop)
+		addr_cells = be32_to_cpup(prop);
+	prop = fdt_getprop(fdt, parent, "#size-cells", NULL);
+	if (prop)
+		size_cells = be32_to_cpup(prop);
+
+	prop = fdt_getprop(fdt, node, "reg", &len);
+	if (!prop || len < (addr_cells + size_cells) * (int)sizeof(*prop))
+		return false;
+
+	return of_read_number(prop, addr_cells) == region->base &&
+	       of_read_number(prop + addr_cells, size_cells) == region->size;
+}
+
+static void machine_kexec_check_preserved(struct kexec_segment *segment)
+{
+	struct kexec_preserved *region;
+	void *fdt;
+
+	if (!IS_ENABLED(CONFIG_OF_FLATTREE) ||
+	    list_empty(&kexec_preserved_list))
+		return;
+
+	fdt = vmalloc(segment->bufsz);
+	if (!fdt)
+		return;
+	if (copy_from_user(fdt, segment->buf, segment->bufsz) ||
+	    fdt_check_header(fdt) || fdt_totalsize(fdt) > segment->bufsz)
+		goto out;
+
+	list_for_each_entry(region, &kexec_preserved_list, list) {
+		int node = -1;
+
+		do {
+			node = fdt_node_offset_by_compatible(fdt, node,
+						"linux,kexec-preserved");
+		} while (node >= 0 &&
+			 strcmp(fdt_getprop(fdt, node, "label", NULL) ?: "",
+				region->label));
+
+		if (node < 0)
+			pr_warn("kexec: %s is not reserved in the new DTB and will be lost\n",
+				region->label);
+		else if (!machine_kexec_fdt_reg_matches(fdt, node, region))
+			pr_warn("kexec: %s is reserved at the wrong place in the new DTB and will be lost\n",
+				region->label);
+	}
+out:
+	vfree(fdt);
+}
+
 int machine_kexec_prepare(struct kimage *image)
 {
 	struct kexec_segment *current_segment;
@@ -65,8 +142,10 @@ int machine_kexec_prepare(struct kimage *image)
 		if (err)
 			return err;
 
-		if (be32_to_cpu(header) == OF_DT_HEADER)
+		if (be32_to_cpu(header) == OF_DT_HEADER) {
 			dt_mem = current_segment->mem;
+			machine_kexec_check_preserved(current_segment);
+		}
 	}
 	return 0;
 }
@@ -19,6 +19,7 @@
 
 #include <linux/elf.h>
 #include <linux/err.h>
+#include <linux/hrtimer.h>
 #include <linux/kernel.h>
 #include <linux/mm.h>
 #include <linux/of.h>
@@ -167,10 +168,13 @@ static void __init patch_vdso(void *ehdr)
 	 * want programs to incur the slight additional overhead of
 	 * dispatching through the VDSO only to fall back to syscalls.
 	 */
-	if (!cntvct_ok) {
+	if (!cntvct_ok)
 		vdso_nullpatch_one(&einfo, "__vdso_gettimeofday");
-		vdso_nullpatch_one(&einfo, "__vdso_clock_gettime");
-	}
+
+	/* __vdso_clock_gettime is kept for the coarse clocks, and falls
+	 * back to the syscall for the others without the counter.
+	 * __vdso_clock_getres and __vdso_time don't read the counter.
+	 */
 }
 
 static int __init vdso_init(void)
@@ -267,7 +271,7 @@ static void vdso_write_end(struct vdso_data *vdata)
 
 static bool tk_is_cntvct(const struct timekeeper *tk)
 {
-	if (!IS_ENABLED(CONFIG_ARM_ARCH_TIMER))
+	if (!IS_ENABLED(CONFIG_ARM_ARCH_TIMER) || !cntvct_ok)
 		return false;
 
 	if (strcmp(tk->tkr_mono.clock->name, "arch_sys_counter") != 0)
@@ -281,10 +285,10 @@ static bool tk_is_cntvct(const struct timekeeper *tk)
  *
  * Increment the sequence counter, making it odd, indicating to
  * userspace that an update is in progress.  Update the fields used
- * for coarse clocks and, if the architected system timer is in use,
- * the fields used for high precision clocks.  Increment the sequence
- * counter again, making it even, indicating to userspace that the
- * update is finished.
+ * for coarse clocks, time() and clock_getres() and, if the architected
+ * system timer is in use, the fields used for high precision clocks.
+ * Increment the sequence counter again, making it even, indicating to
+ * userspace that the update is finished.
  *
  * Userspace is expected to sample seq_count before reading any other
  * fields from the data page.  If seq_count is odd, userspace is
@@ -296,24 +300,26 @@ static bool tk_is_cntvct(const struct timekeeper *tk)
  */
 void update_vsyscall(struct timekeeper *tk)
 {
-	struct timespec xtime_coarse;
+	struct timespec xtime_coarse, btm, res;
 	struct timespec64 *wtm = &tk->wall_to_monotonic;
 
-	if (!cntvct_ok) {
-		/* The entry points have been zeroed, so there is no
-		 * point in updating the data page.
-		 */
-		return;
-	}
+	/* Even without a usable counter, __vdso_time and
+	 * __vdso_clock_getres are served from the data page.
+	 */
+	xtime_coarse = __current_kernel_time();
+	btm = ktime_to_timespec(tk->offs_boot);
+	hrtimer_get_res(CLOCK_MONOTONIC, &res);
 
 	vdso_write_begin(vdso_data);
 
-	xtime_coarse = __current_kernel_time();
 	vdso_data->tk_is_cntvct			= tk_is_cntvct(tk);
 	vdso_data->xtime_coarse_sec		= xtime_coarse.tv_sec;
 	vdso_data->xtime_coarse_nsec		= xtime_coarse.tv_nsec;
 	vdso_data->wtm_clock_sec		= wtm->tv_sec;
 	vdso_data->wtm_clock_nsec		= wtm->tv_nsec;
+	vdso_data->btm_sec			= btm.tv_sec;
+	vdso_data->btm_nsec			= btm.tv_nsec;
+	vdso_data->hrtimer_res			= res.tv_nsec;
 
 	if (vdso_data->tk_is_cntvct) {
 		vdso_data->cs_cycle_last	= tk->tkr_mono.cycle_last;
@@ -322,6 +328,9 @@ void update_vsyscall(struct timekeeper *tk)
 		vdso_data->cs_mult		= tk->tkr_mono.mult;
 		vdso_data->cs_shift		= tk->tkr_mono.shift;
 		vdso_data->cs_mask		= tk->tkr_mono.mask;
+		vdso_data->raw_time_sec		= tk->raw_time.tv_sec;
+		vdso_data->raw_time_nsec	= tk->raw_time.tv_nsec;
+		vdso_data->cs_raw_mult		= tk->tkr_raw.mult;
 	}
 
 	vdso_write_end(vdso_data);
@@ -0,0 +1,44 @@
+/*
+ * linux/arch/arm/lib/copy-neon.c
+ *
+ * Block copy using NEON
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Each iteration moves a cache line's worth of data through four q
+ * registers, with the loads issued ahead of the stores, and prefetches a
+ * few lines ahead since the Cortex-A8 L2 prefetcher won't cross pages.
+ */
+
+#include <asm/copy-neon.h>
+#include <arm_neon.h>
+
+#ifndef __ARM_NEON__
+#error You should compile this file with '-mfloat-abi=softfp -mfpu=neon'
+#endif
+
+#define COPY_NEON_PREFETCH	(4 * COPY_NEON_BLOCK)
+
+void copy_neon(void *dst, const void *src, size_t len)
+{
+	const u8 *s = src;
+	u8 *d = dst;
+
+	for (; len >= COPY_NEON_BLOCK; len -= COPY_NEON_BLOCK) {
+		uint8x16_t x0, x1, x2, x3;
+
+		__builtin_prefetch(s + COPY_NEON_PREFETCH);
+		x0 = vld1q_u8(s);
+		x1 = vld1q_u8(s + 16);
+		x2 = vld1q_u8(s + 32);
+		x3 = vld1q_u8(s + 48);
+		vst1q_u8(d, x0);
+		vst1q_u8(d + 16, x1);
+		vst1q_u8(d + 32, x2);
+		vst1q_u8(d + 48, x3);
+		s += COPY_NEON_BLOCK;
+		d += COPY_NEON_BLOCK;
+	}
+}
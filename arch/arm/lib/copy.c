@@ -0,0 +1,67 @@
+/*
+ * linux/arch/arm/lib/copy.c
+ *
+ * copy_page_neon() and memcpy_large(), using NEON where it is allowed
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/kernel.h>
+#include <linux/export.h>
+#include <linux/moduleparam.h>
+#include <linux/string.h>
+#include <asm/copy-neon.h>
+#include <asm/neon.h>
+#include <asm/page.h>
+
+/*
+ * memcpy_large() only uses NEON from this size up, below it saving the
+ * VFP state costs more than NEON gains.  Setting it to a huge value turns
+ * NEON off for both memcpy_large() and copy_page_neon().
+ */
+static unsigned int neon_min_len = 1024;
+module_param(neon_min_len, uint, 0644);
+MODULE_PARM_DESC(neon_min_len, "Smallest copy to do with NEON");
+
+/*
+ * copy_page() itself stays the plain ARM routine, as it is also used
+ * where kernel_neon_begin() can't be, e.g. by the hibernation restore
+ * code while the kernel image is being overwritten.
+ */
+void copy_page_neon(void *to, const void *from)
+{
+	if (!kernel_neon_ok(PAGE_SIZE, neon_min_len)) {
+		copy_page(to, from);
+		return;
+	}
+
+	kernel_neon_begin();
+	copy_neon(to, from, PAGE_SIZE);
+	kernel_neon_end();
+}
+EXPORT_SYMBOL(copy_page_neon);
+
+/*
+ * memcpy() for callers that know their buffer may be big and that they
+ * aren't running in interrupt context, e.g. linearizing an skb.  memcpy()
+ * itself can't use NEON as it is called from everywhere, including the
+ * VFP code and before the VFP is set up.
+ */
+void *memcpy_large(void *dest, const void *src, size_t count)
+{
+	size_t n;
+
+	if (!kernel_neon_ok(count, neon_min_len))
+		return memcpy(dest, src, count);
+
+	n = round_down(count, COPY_NEON_BLOCK);
+	kernel_neon_begin();
+	copy_neon(dest, src, n);
+	kernel_neon_end();
+
+	memcpy(dest + n, src + n, count - n);
+	return dest;
+}
+EXPORT_SYMBOL(memcpy_large);
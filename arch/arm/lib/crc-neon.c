@@ -0,0 +1,174 @@
+/*
+ * linux/arch/arm/lib/crc-neon.c
+ *
+ * CRC folding using the NEON 8x8 bit polynomial multiply instruction
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * ARMv7 NEON has no 64x64 bit carry-less multiply, so it is built out of
+ * vmull.p8 as described in "Fast Software Polynomial Multiplication on
+ * ARM Processors Using the NEON Engine" by Camara, Gouvea, Lopez and
+ * Dahab.  The input is then folded four 16 byte lanes at a time, as in
+ * Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ".
+ * The final 16 bytes are left for the table driven code to reduce.
+ */
+
+#include <linux/export.h>
+#include <asm/crc-neon.h>
+#include <arm_neon.h>
+
+#ifndef __ARM_NEON__
+#error You should compile this file with '-mfloat-abi=softfp -mfpu=neon'
+#endif
+
+static inline uint64x2_t fixup(uint64x2_t t, u64 mask)
+{
+	uint64x1_t lo = vget_low_u64(t);
+	uint64x1_t hi = vget_high_u64(t);
+
+	lo = veor_u64(lo, hi);
+	hi = vand_u64(hi, vcreate_u64(mask));
+	lo = veor_u64(lo, hi);
+	return vcombine_u64(lo, hi);
+}
+
+static inline uint8x16_t mull_p8(uint8x8_t a, uint8x8_t b)
+{
+	return vreinterpretq_u8_p16(vmull_p8(vreinterpret_p8_u8(a),
+					     vreinterpret_p8_u8(b)));
+}
+
+/* 64x64 -> 128 bit carry-less multiplication */
+static inline uint64x2_t pmull64(u64 x, u64 y)
+{
+	uint8x8_t a = vreinterpret_u8_u64(vcreate_u64(x));
+	uint8x8_t b = vreinterpret_u8_u64(vcreate_u64(y));
+	uint64x2_t t0, t1, t2, t3, r;
+
+	/* L = A1*B + A*B1, M = A2*B + A*B2, N = A3*B + A*B3, K = A*B4 */
+	t0 = vreinterpretq_u64_u8(veorq_u8(mull_p8(vext_u8(a, a, 1), b),
+					   mull_p8(a, vext_u8(b, b, 1))));
+	t1 = vreinterpretq_u64_u8(veorq_u8(mull_p8(vext_u8(a, a, 2), b),
+					   mull_p8(a, vext_u8(b, b, 2))));
+	t2 = vreinterpretq_u64_u8(veorq_u8(mull_p8(vext_u8(a, a, 3), b),
+					   mull_p8(a, vext_u8(b, b, 3))));
+	t3 = vreinterpretq_u64_u8(mull_p8(a, vext_u8(b, b, 4)));
+
+	t0 = fixup(t0, 0x0000ffffffffffffULL);
+	t1 = fixup(t1, 0x00000000ffffffffULL);
+	t2 = fixup(t2, 0x000000000000ffffULL);
+	t3 = fixup(t3, 0);
+
+	t0 = vreinterpretq_u64_u8(vextq_u8(vreinterpretq_u8_u64(t0),
+					   vreinterpretq_u8_u64(t0), 15));
+	t1 = vreinterpretq_u64_u8(vextq_u8(vreinterpretq_u8_u64(t1),
+					   vreinterpretq_u8_u64(t1), 14));
+	t2 = vreinterpretq_u64_u8(vextq_u8(vreinterpretq_u8_u64(t2),
+					   vreinterpretq_u8_u64(t2), 13));
+	t3 = vreinterpretq_u64_u8(vextq_u8(vreinterpretq_u8_u64(t3),
+					   vreinterpretq_u8_u64(t3), 12));
+
+	r = vreinterpretq_u64_u8(mull_p8(a, b));
+	r = veorq_u64(r, veorq_u64(t0, t1));
+	return veorq_u64(r, veorq_u64(t2, t3));
+}
+
+/* bit reflected: lane 0 holds the high order coefficients */
+static inline uint64x2_t fold_le(uint64x2_t x, const u64 *k)
+{
+	return veorq_u64(pmull64(vgetq_lane_u64(x, 0), k[0]),
+			 pmull64(vgetq_lane_u64(x, 1), k[1]));
+}
+
+static inline uint64x2_t load_le(const u8 *p)
+{
+	return vreinterpretq_u64_u8(vld1q_u8(p));
+}
+
+void crc_fold_neon_le(const struct crc_fold_consts *c, u32 crc,
+		      const u8 *p, size_t len, u8 *out)
+{
+	uint64x2_t x0, x1, x2, x3;
+
+	x0 = veorq_u64(load_le(p), vcombine_u64(vcreate_u64(crc),
+						vcreate_u64(0)));
+	x1 = load_le(p + 16);
+	x2 = load_le(p + 32);
+	x3 = load_le(p + 48);
+	p += 64;
+	len -= 64;
+
+	while (len >= 64) {
+		x0 = veorq_u64(fold_le(x0, &c->k[0]), load_le(p));
+		x1 = veorq_u64(fold_le(x1, &c->k[0]), load_le(p + 16));
+		x2 = veorq_u64(fold_le(x2, &c->k[0]), load_le(p + 32));
+		x3 = veorq_u64(fold_le(x3, &c->k[0]), load_le(p + 48));
+		p += 64;
+		len -= 64;
+	}
+
+	x3 = veorq_u64(x3, fold_le(x0, &c->k[2]));
+	x3 = veorq_u64(x3, fold_le(x1, &c->k[4]));
+	x3 = veorq_u64(x3, fold_le(x2, &c->k[6]));
+
+	while (len >= 16) {
+		x3 = veorq_u64(fold_le(x3, &c->k[6]), load_le(p));
+		p += 16;
+		len -= 16;
+	}
+
+	vst1q_u8(out, vreinterpretq_u8_u64(x3));
+}
+EXPORT_SYMBOL_GPL(crc_fold_neon_le);
+
+/* normal bit order: lane 0 holds the high order coefficients */
+static inline uint64x2_t fold_be(uint64x2_t x, const u64 *k)
+{
+	uint64x2_t r = veorq_u64(pmull64(vgetq_lane_u64(x, 0), k[0]),
+				 pmull64(vgetq_lane_u64(x, 1), k[1]));
+
+	return vcombine_u64(vget_high_u64(r), vget_low_u64(r));
+}
+
+static inline uint64x2_t load_be(const u8 *p)
+{
+	return vreinterpretq_u64_u8(vrev64q_u8(vld1q_u8(p)));
+}
+
+void crc_fold_neon_be(const struct crc_fold_consts *c, u32 crc,
+		      const u8 *p, size_t len, u8 *out)
+{
+	uint64x2_t x0, x1, x2, x3;
+
+	x0 = veorq_u64(load_be(p), vcombine_u64(vcreate_u64((u64)crc << 32),
+						vcreate_u64(0)));
+	x1 = load_be(p + 16);
+	x2 = load_be(p + 32);
+	x3 = load_be(p + 48);
+	p += 64;
+	len -= 64;
+
+	while (len >= 64) {
+		x0 = veorq_u64(fold_be(x0, &c->k[0]), load_be(p));
+		x1 = veorq_u64(fold_be(x1, &c->k[0]), load_be(p + 16));
+		x2 = veorq_u64(fold_be(x2, &c->k[0]), load_be(p + 32));
+		x3 = veorq_u64(fold_be(x3, &c->k[0]), load_be(p + 48));
+		p += 64;
+		len -= 64;
+	}
+
+	x3 = veorq_u64(x3, fold_be(x0, &c->k[2]));
+	x3 = veorq_u64(x3, fold_be(x1, &c->k[4]));
+	x3 = veorq_u64(x3, fold_be(x2, &c->k[6]));
+
+	while (len >= 16) {
+		x3 = veorq_u64(fold_be(x3, &c->k[6]), load_be(p));
+		p += 16;
+		len -= 16;
+	}
+
+	vst1q_u8(out, vrev64q_u8(vreinterpretq_u8_u64(x3)));
+}
+EXPORT_SYMBOL_GPL(crc_fold_neon_be);
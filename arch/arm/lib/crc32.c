@@ -0,0 +1,95 @@
+/*
+ * linux/arch/arm/lib/crc32.c
+ *
+ * Accelerated crc32_le() and __crc32c_le(), selected at boot
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/crc32.h>
+#include <linux/init.h>
+#include <linux/jump_label.h>
+#include <linux/kernel.h>
+#include <asm/crc-neon.h>
+#include <asm/hwcap.h>
+#include <asm/neon.h>
+
+/*
+ * Below this size the table driven code wins over the NEON version once
+ * the cost of kernel_neon_begin() and of the final reduction is included.
+ */
+#define CRC32_NEON_MIN_LEN	256
+
+asmlinkage u32 crc32_armv8_le(u32 crc, unsigned char const *p, size_t len);
+asmlinkage u32 crc32c_armv8_le(u32 crc, unsigned char const *p, size_t len);
+
+static struct static_key crc32_use_armv8 = STATIC_KEY_INIT_FALSE;
+
+#ifdef CONFIG_KERNEL_MODE_NEON
+static const struct crc_fold_consts crc32_consts = { {
+	0x653d982200000000ULL, 0xcad38e8f00000000ULL,
+	0x69ccfc0d00000000ULL, 0x2a28386200000000ULL,
+	0x9570d49500000000ULL, 0x01b5fd1d00000000ULL,
+	0x65673b4600000000ULL, 0x9ba54c6f00000000ULL,
+} };
+
+static const struct crc_fold_consts crc32c_consts = { {
+	0x1c19243b00000000ULL, 0x75bba45b00000000ULL,
+	0xa46ef4aa00000000ULL, 0x6051243f00000000ULL,
+	0x33ccbbbc00000000ULL, 0xa2158b3400000000ULL,
+	0x3743f7bd00000000ULL, 0x3171d43000000000ULL,
+} };
+
+static u32 crc32_neon_le(const struct crc_fold_consts *consts,
+			 u32 (*base)(u32, unsigned char const *, size_t),
+			 u32 crc, unsigned char const *p, size_t len)
+{
+	u8 buf[16] __aligned(8);
+
+	kernel_neon_begin();
+	crc_fold_neon_le(consts, crc, p, len, buf);
+	kernel_neon_end();
+
+	crc = base(0, buf, sizeof(buf));
+	return base(crc, p + round_down(len, 16), len % 16);
+}
+#endif
+
+u32 __pure crc32_le(u32 crc, unsigned char const *p, size_t len)
+{
+#ifdef CONFIG_AS_CRC32
+	if (static_key_false(&crc32_use_armv8))
+		return crc32_armv8_le(crc, p, len);
+#endif
+#ifdef CONFIG_KERNEL_MODE_NEON
+	if (kernel_neon_ok(len, CRC32_NEON_MIN_LEN))
+		return crc32_neon_le(&crc32_consts, crc32_le_base, crc, p, len);
+#endif
+	return crc32_le_base(crc, p, len);
+}
+
+u32 __pure __crc32c_le(u32 crc, unsigned char const *p, size_t len)
+{
+#ifdef CONFIG_AS_CRC32
+	if (static_key_false(&crc32_use_armv8))
+		return crc32c_armv8_le(crc, p, len);
+#endif
+#ifdef CONFIG_KERNEL_MODE_NEON
+	if (kernel_neon_ok(len, CRC32_NEON_MIN_LEN))
+		return crc32_neon_le(&crc32c_consts, __crc32c_le_base,
+				     crc, p, len);
+#endif
+	return __crc32c_le_base(crc, p, len);
+}
+
+static int __init crc32_arm_init(void)
+{
+	if (IS_ENABLED(CONFIG_AS_CRC32) && (elf_hwcap2 & HWCAP2_CRC32)) {
+		static_key_slow_inc(&crc32_use_armv8);
+		pr_info("crc32: using ARMv8 CRC32 instructions\n");
+	}
+	return 0;
+}
+arch_initcall(crc32_arm_init);
@@ -0,0 +1,72 @@
+/*
+ * linux/arch/arm/lib/csum-neon.c
+ *
+ * Internet checksum using NEON
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * The ones' complement sum does not depend on the word size it is computed
+ * with, so the data is summed as 32-bit words, and vpadal folds each pair
+ * of them into a 64-bit lane which can't overflow for any sensible length.
+ * Four accumulators hide the latency of vpadal.
+ */
+
+#include <asm/csum-neon.h>
+#include <arm_neon.h>
+
+#ifndef __ARM_NEON__
+#error You should compile this file with '-mfloat-abi=softfp -mfpu=neon'
+#endif
+
+static inline u64 csum_reduce(uint64x2_t a0, uint64x2_t a1, uint64x2_t a2,
+			      uint64x2_t a3)
+{
+	uint64x2_t a = vaddq_u64(vaddq_u64(a0, a1), vaddq_u64(a2, a3));
+
+	return vgetq_lane_u64(a, 0) + vgetq_lane_u64(a, 1);
+}
+
+u64 csum_partial_neon(const void *src, size_t len)
+{
+	const u8 *p = src;
+	uint64x2_t a0 = vdupq_n_u64(0), a1 = a0, a2 = a0, a3 = a0;
+
+	for (; len >= CSUM_NEON_BLOCK; len -= CSUM_NEON_BLOCK) {
+		a0 = vpadalq_u32(a0, vreinterpretq_u32_u8(vld1q_u8(p)));
+		a1 = vpadalq_u32(a1, vreinterpretq_u32_u8(vld1q_u8(p + 16)));
+		a2 = vpadalq_u32(a2, vreinterpretq_u32_u8(vld1q_u8(p + 32)));
+		a3 = vpadalq_u32(a3, vreinterpretq_u32_u8(vld1q_u8(p + 48)));
+		p += CSUM_NEON_BLOCK;
+	}
+
+	return csum_reduce(a0, a1, a2, a3);
+}
+
+u64 csum_partial_copy_neon(const void *src, void *dst, size_t len)
+{
+	const u8 *s = src;
+	u8 *d = dst;
+	uint64x2_t a0 = vdupq_n_u64(0), a1 = a0, a2 = a0, a3 = a0;
+
+	for (; len >= CSUM_NEON_BLOCK; len -= CSUM_NEON_BLOCK) {
+		uint8x16_t x0 = vld1q_u8(s);
+		uint8x16_t x1 = vld1q_u8(s + 16);
+		uint8x16_t x2 = vld1q_u8(s + 32);
+		uint8x16_t x3 = vld1q_u8(s + 48);
+
+		vst1q_u8(d, x0);
+		vst1q_u8(d + 16, x1);
+		vst1q_u8(d + 32, x2);
+		vst1q_u8(d + 48, x3);
+		a0 = vpadalq_u32(a0, vreinterpretq_u32_u8(x0));
+		a1 = vpadalq_u32(a1, vreinterpretq_u32_u8(x1));
+		a2 = vpadalq_u32(a2, vreinterpretq_u32_u8(x2));
+		a3 = vpadalq_u32(a3, vreinterpretq_u32_u8(x3));
+		s += CSUM_NEON_BLOCK;
+		d += CSUM_NEON_BLOCK;
+	}
+
+	return csum_reduce(a0, a1, a2, a3);
+}
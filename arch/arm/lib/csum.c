@@ -0,0 +1,95 @@
+/*
+ * linux/arch/arm/lib/csum.c
+ *
+ * csum_partial() and friends, using NEON for large buffers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/kernel.h>
+#include <linux/moduleparam.h>
+#include <linux/uaccess.h>
+#include <asm/checksum.h>
+#include <asm/csum-neon.h>
+#include <asm/neon.h>
+
+__wsum csum_partial_arm(const void *buff, int len, __wsum sum);
+__wsum csum_partial_copy_nocheck_arm(const void *src, void *dst, int len,
+				     __wsum sum);
+__wsum csum_partial_copy_from_user_arm(const void __user *src, void *dst,
+				       int len, __wsum sum, int *err_ptr);
+
+/*
+ * Below this size the scalar code wins once kernel_neon_begin() is paid
+ * for.  Writable so that the two can be compared: setting it to a huge
+ * value turns the NEON paths off.
+ */
+static unsigned int neon_min_len = 512;
+module_param(neon_min_len, uint, 0644);
+MODULE_PARM_DESC(neon_min_len, "Smallest buffer to checksum with NEON");
+
+static inline bool csum_neon_ok(int len)
+{
+	return len > 0 && kernel_neon_ok(len, neon_min_len);
+}
+
+/* Add a 64-bit sum into a 32-bit one with end around carry */
+static inline __wsum csum_add64(__wsum sum, u64 s)
+{
+	s += (__force u32)sum;
+	s = (s & 0xffffffff) + (s >> 32);
+	s = (s & 0xffffffff) + (s >> 32);
+	return (__force __wsum)(u32)s;
+}
+
+static __wsum csum_neon(const void *buff, int len, __wsum sum)
+{
+	int n = round_down(len, CSUM_NEON_BLOCK);
+	u64 s;
+
+	kernel_neon_begin();
+	s = csum_partial_neon(buff, n);
+	kernel_neon_end();
+
+	return csum_partial_arm(buff + n, len - n, csum_add64(sum, s));
+}
+
+__wsum csum_partial(const void *buff, int len, __wsum sum)
+{
+	if (csum_neon_ok(len))
+		return csum_neon(buff, len, sum);
+	return csum_partial_arm(buff, len, sum);
+}
+
+__wsum csum_partial_copy_nocheck(const void *src, void *dst, int len,
+				 __wsum sum)
+{
+	int n;
+	u64 s;
+
+	if (!csum_neon_ok(len))
+		return csum_partial_copy_nocheck_arm(src, dst, len, sum);
+
+	n = round_down(len, CSUM_NEON_BLOCK);
+	kernel_neon_begin();
+	s = csum_partial_copy_neon(src, dst, n);
+	kernel_neon_end();
+
+	return csum_partial_copy_nocheck_arm(src + n, dst + n, len - n,
+					     csum_add64(sum, s));
+}
+
+/*
+ * NEON can't take faults on user memory, so copy the data first and sum
+ * it while it is still in the cache.  If the copy faults, start over with
+ * the scalar code, which knows how to report that.
+ */
+__wsum csum_partial_copy_from_user(const void __user *src, void *dst, int len,
+				   __wsum sum, int *err_ptr)
+{
+	if (csum_neon_ok(len) && !__copy_from_user(dst, src, len))
+		return csum_neon(dst, len, sum);
+	return csum_partial_copy_from_user_arm(src, dst, len, sum, err_ptr);
+}
@@ -37,7 +37,7 @@ static void v6_copy_user_highpage_nonaliasing(struct page *to,
 
 	kfrom = kmap_atomic(from);
 	kto = kmap_atomic(to);
-	copy_page(kto, kfrom);
+	copy_page_neon(kto, kfrom);
 	kunmap_atomic(kto);
 	kunmap_atomic(kfrom);
 }
@@ -76,6 +76,23 @@ static notrace long clock_gettime_fallback(clockid_t _clkid,
 	return ret;
 }
 
+static notrace long clock_getres_fallback(clockid_t _clkid,
+					  struct timespec *_ts)
+{
+	register struct timespec *ts asm("r1") = _ts;
+	register clockid_t clkid asm("r0") = _clkid;
+	register long ret asm ("r0");
+	register long nr asm("r7") = __NR_clock_getres;
+
+	asm volatile(
+	"	swi #0\n"
+	: "=r" (ret)
+	: "r" (clkid), "r" (ts), "r" (nr)
+	: "memory");
+
+	return ret;
+}
+
 static notrace int do_realtime_coarse(struct timespec *ts,
 				      struct vdso_data *vdata)
 {
@@ -133,6 +150,19 @@ static notrace u64 get_ns(struct vdso_data *vdata)
 	return nsec;
 }
 
+/* CLOCK_MONOTONIC_RAW is accumulated in whole nanoseconds */
+static notrace u64 get_ns_raw(struct vdso_data *vdata)
+{
+	u64 cycle_delta;
+	u64 cycle_now;
+
+	cycle_now = arch_counter_get_cntvct();
+
+	cycle_delta = (cycle_now - vdata->cs_cycle_last) & vdata->cs_mask;
+
+	return (cycle_delta * vdata->cs_raw_mult) >> vdata->cs_shift;
+}
+
 static notrace int do_realtime(struct timespec *ts, struct vdso_data *vdata)
 {
 	u64 nsecs;
@@ -182,6 +212,56 @@ static notrace int do_monotonic(struct timespec *ts, struct vdso_data *vdata)
 	return 0;
 }
 
+static notrace int do_boottime(struct timespec *ts, struct vdso_data *vdata)
+{
+	struct timespec toboot;
+	u64 nsecs;
+	u32 seq;
+
+	do {
+		seq = vdso_read_begin(vdata);
+
+		if (!vdata->tk_is_cntvct)
+			return -1;
+
+		ts->tv_sec = vdata->xtime_clock_sec;
+		nsecs = get_ns(vdata);
+
+		toboot.tv_sec = vdata->wtm_clock_sec + vdata->btm_sec;
+		toboot.tv_nsec = vdata->wtm_clock_nsec + vdata->btm_nsec;
+
+	} while (vdso_read_retry(vdata, seq));
+
+	ts->tv_sec += toboot.tv_sec;
+	ts->tv_nsec = 0;
+	timespec_add_ns(ts, nsecs + toboot.tv_nsec);
+
+	return 0;
+}
+
+static notrace int do_monotonic_raw(struct timespec *ts,
+				    struct vdso_data *vdata)
+{
+	u64 nsecs;
+	u32 seq;
+
+	do {
+		seq = vdso_read_begin(vdata);
+
+		if (!vdata->tk_is_cntvct)
+			return -1;
+
+		ts->tv_sec = vdata->raw_time_sec;
+		nsecs = vdata->raw_time_nsec + get_ns_raw(vdata);
+
+	} while (vdso_read_retry(vdata, seq));
+
+	ts->tv_nsec = 0;
+	timespec_add_ns(ts, nsecs);
+
+	return 0;
+}
+
 #else /* CONFIG_ARM_ARCH_TIMER */
 
 static notrace int do_realtime(struct timespec *ts, struct vdso_data *vdata)
@@ -194,6 +274,17 @@ static notrace int do_monotonic(struct timespec *ts, struct vdso_data *vdata)
 	return -1;
 }
 
+static notrace int do_boottime(struct timespec *ts, struct vdso_data *vdata)
+{
+	return -1;
+}
+
+static notrace int do_monotonic_raw(struct timespec *ts,
+				    struct vdso_data *vdata)
+{
+	return -1;
+}
+
 #endif /* CONFIG_ARM_ARCH_TIMER */
 
 notrace int __vdso_clock_gettime(clockid_t clkid, struct timespec *ts)
@@ -216,6 +307,12 @@ notrace int __vdso_clock_gettime(clockid_t clkid, struct timespec *ts)
 	case CLOCK_MONOTONIC:
 		ret = do_monotonic(ts, vdata);
 		break;
+	case CLOCK_BOOTTIME:
+		ret = do_boottime(ts, vdata);
+		break;
+	case CLOCK_MONOTONIC_RAW:
+		ret = do_monotonic_raw(ts, vdata);
+		break;
 	default:
 		break;
 	}
@@ -226,6 +323,55 @@ notrace int __vdso_clock_gettime(clockid_t clkid, struct timespec *ts)
 	return ret;
 }
 
+notrace int __vdso_clock_getres(clockid_t clkid, struct timespec *res)
+{
+	struct vdso_data *vdata;
+	u32 nsec;
+
+	vdata = __get_datapage();
+
+	switch (clkid) {
+	case CLOCK_REALTIME:
+	case CLOCK_MONOTONIC:
+	case CLOCK_BOOTTIME:
+	case CLOCK_MONOTONIC_RAW:
+		nsec = ACCESS_ONCE(vdata->hrtimer_res);
+		break;
+	case CLOCK_REALTIME_COARSE:
+	case CLOCK_MONOTONIC_COARSE:
+		nsec = LOW_RES_NSEC;
+		break;
+	default:
+		nsec = 0;
+		break;
+	}
+
+	/* Not filled in yet, or a clock we don't know about */
+	if (!nsec)
+		return clock_getres_fallback(clkid, res);
+
+	if (res) {
+		res->tv_sec = 0;
+		res->tv_nsec = nsec;
+	}
+
+	return 0;
+}
+
+notrace time_t __vdso_time(time_t *t)
+{
+	struct vdso_data *vdata;
+	time_t now;
+
+	vdata = __get_datapage();
+
+	now = ACCESS_ONCE(vdata->xtime_coarse_sec);
+	if (t)
+		*t = now;
+
+	return now;
+}
+
 static notrace long gettimeofday_fallback(struct timeval *_tv,
 					  struct timezone *_tz)
 {
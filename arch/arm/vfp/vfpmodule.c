@@ -12,6 +12,7 @@
 #include <linux/cpu.h>
 #include <linux/cpu_pm.h>
 #include <linux/hardirq.h>
+#include <linux/jump_label.h>
 #include <linux/kernel.h>
 #include <linux/notifier.h>
 #include <linux/signal.h>
@@ -24,6 +25,7 @@
 
 #include <asm/cp15.h>
 #include <asm/cputype.h>
+#include <asm/neon.h>
 #include <asm/system_info.h>
 #include <asm/thread_notify.h>
 #include <asm/vfp.h>
@@ -671,6 +673,10 @@ void vfp_kmode_exception(void)
 
 #ifdef CONFIG_KERNEL_MODE_NEON
 
+/* Set once vfp_init() has found a NEON unit, see kernel_neon_ok() */
+struct static_key kernel_neon_usable = STATIC_KEY_INIT_FALSE;
+EXPORT_SYMBOL(kernel_neon_usable);
+
 /*
  * Kernel-side NEON support functions
  */
@@ -797,6 +803,10 @@ static int __init vfp_init(void)
 	 * in place; report VFP support to userspace.
 	 */
 	elf_hwcap |= HWCAP_VFP;
+#ifdef CONFIG_KERNEL_MODE_NEON
+	if (cpu_has_neon())
+		static_key_slow_inc(&kernel_neon_usable);
+#endif
 
 	pr_cont("implementor %02x architecture %d part %02x variant %x rev %x\n",
 		(vfpsid & FPSID_IMPLEMENTER_MASK) >> FPSID_IMPLEMENTER_BIT,
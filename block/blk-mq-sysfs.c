@@ -213,6 +213,42 @@ static ssize_t blk_mq_hw_sysfs_active_show(struct blk_mq_hw_ctx *hctx, char *pag
 	return sprintf(page, "%u\n", atomic_read(&hctx->nr_active));
 }
 
+static ssize_t blk_mq_hw_sysfs_poll_show(struct blk_mq_hw_ctx *hctx, char *page)
+{
+	return sprintf(page, "considered=%lu\ninvoked=%lu\nsuccess=%lu\n"
+			"sleep=%lu\n", hctx->poll_considered,
+			hctx->poll_invoked, hctx->poll_success,
+			hctx->poll_sleep);
+}
+
+static ssize_t blk_mq_hw_sysfs_poll_store(struct blk_mq_hw_ctx *hctx,
+					  const char *page, size_t size)
+{
+	hctx->poll_considered = hctx->poll_invoked = 0;
+	hctx->poll_success = hctx->poll_sleep = 0;
+	memset(hctx->poll_stat, 0, sizeof(hctx->poll_stat));
+
+	return size;
+}
+
+static ssize_t blk_mq_hw_sysfs_poll_stat_show(struct blk_mq_hw_ctx *hctx,
+					      char *page)
+{
+	char *start_page = page;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(hctx->poll_stat); i++) {
+		struct blk_mq_poll_stat *stat = &hctx->poll_stat[i];
+
+		page += sprintf(page, "%s: samples=%llu mean=%llu min=%llu "
+				"max=%llu\n", i == READ ? "read" : "write",
+				stat->nr_samples, stat->mean, stat->min,
+				stat->max);
+	}
+
+	return page - start_page;
+}
+
 static ssize_t blk_mq_hw_sysfs_cpus_show(struct blk_mq_hw_ctx *hctx, char *page)
 {
 	unsigned int i, first = 1;
@@ -288,6 +324,15 @@ static struct blk_mq_hw_ctx_sysfs_entry blk_mq_hw_sysfs_cpus = {
 	.attr = {.name = "cpu_list", .mode = S_IRUGO },
 	.show = blk_mq_hw_sysfs_cpus_show,
 };
+static struct blk_mq_hw_ctx_sysfs_entry blk_mq_hw_sysfs_poll = {
+	.attr = {.name = "io_poll", .mode = S_IRUGO | S_IWUSR },
+	.show = blk_mq_hw_sysfs_poll_show,
+	.store = blk_mq_hw_sysfs_poll_store,
+};
+static struct blk_mq_hw_ctx_sysfs_entry blk_mq_hw_sysfs_poll_stat = {
+	.attr = {.name = "io_poll_stat", .mode = S_IRUGO },
+	.show = blk_mq_hw_sysfs_poll_stat_show,
+};
 
 static struct attribute *default_hw_ctx_attrs[] = {
 	&blk_mq_hw_sysfs_queued.attr,
@@ -297,6 +342,8 @@ static struct attribute *default_hw_ctx_attrs[] = {
 	&blk_mq_hw_sysfs_tags.attr,
 	&blk_mq_hw_sysfs_cpus.attr,
 	&blk_mq_hw_sysfs_active.attr,
+	&blk_mq_hw_sysfs_poll.attr,
+	&blk_mq_hw_sysfs_poll_stat.attr,
 	NULL,
 };
 
@@ -202,6 +202,7 @@ static void blk_mq_rq_ctx_init(struct request_queue *q, struct blk_mq_ctx *ctx,
 	set_start_time_ns(rq);
 	rq->io_start_time_ns = 0;
 #endif
+	rq->issue_time_ns = 0;
 	rq->nr_phys_segments = 0;
 #if defined(CONFIG_BLK_DEV_INTEGRITY)
 	rq->nr_integrity_segments = 0;
@@ -324,10 +325,42 @@ void blk_mq_free_request(struct request *rq)
 }
 EXPORT_SYMBOL_GPL(blk_mq_free_request);
 
+static void blk_mq_poll_stat_add(struct request *rq)
+{
+	struct request_queue *q = rq->q;
+	struct blk_mq_hw_ctx *hctx = q->mq_ops->map_queue(q, rq->mq_ctx->cpu);
+	struct blk_mq_poll_stat *stat = &hctx->poll_stat[rq_data_dir(rq)];
+	u64 now = ktime_get_ns();
+	u64 delta;
+
+	if (now < rq->issue_time_ns)
+		return;
+	delta = now - rq->issue_time_ns;
+
+	/*
+	 * Updates are not serialized against completions on other CPUs
+	 * mapped to the same hardware queue; the occasional lost sample
+	 * is fine for a latency estimate.
+	 */
+	if (!stat->nr_samples) {
+		stat->mean = stat->min = stat->max = delta;
+	} else {
+		stat->mean = (stat->mean * 7 + delta) >> 3;
+		if (delta < stat->min)
+			stat->min = delta;
+		if (delta > stat->max)
+			stat->max = delta;
+	}
+	stat->nr_samples++;
+}
+
 inline void __blk_mq_end_request(struct request *rq, int error)
 {
 	blk_account_io_done(rq);
 
+	if (rq->issue_time_ns)
+		blk_mq_poll_stat_add(rq);
+
 	if (rq->end_io) {
 		rq->end_io(rq, error);
 	} else {
@@ -420,6 +453,9 @@ void blk_mq_start_request(struct request *rq)
 
 	trace_block_rq_issue(q, rq);
 
+	if (blk_queue_poll(q))
+		rq->issue_time_ns = ktime_get_ns();
+
 	rq->resid_len = blk_rq_bytes(rq);
 	if (unlikely(blk_bidi_rq(rq)))
 		rq->next_rq->resid_len = blk_rq_bytes(rq->next_rq);
@@ -1389,6 +1425,124 @@ run_queue:
 	blk_mq_put_ctx(data.ctx);
 }
 
+/*
+ * Work out how long to sleep before we start spinning on the hardware
+ * queue: either the fixed value set through sysfs, or half of the mean
+ * completion time seen so far for this data direction.
+ */
+static u64 blk_mq_poll_nsecs(struct request_queue *q,
+			     struct blk_mq_hw_ctx *hctx, int rw)
+{
+	struct blk_mq_poll_stat *stat = &hctx->poll_stat[rw & WRITE];
+
+	if (q->poll_nsec > 0)
+		return q->poll_nsec;
+
+	/*
+	 * Don't sleep until we have a handful of samples, a single slow
+	 * completion shouldn't make us oversleep on a fast device.
+	 */
+	if (stat->nr_samples < 8)
+		return 0;
+
+	return (stat->mean + 1) / 2;
+}
+
+static bool blk_mq_poll_hybrid_sleep(struct request_queue *q,
+				     struct blk_mq_hw_ctx *hctx, int rw)
+{
+	struct hrtimer_sleeper hs;
+	u64 nsecs;
+
+	if (q->poll_nsec == -1)
+		return false;
+
+	nsecs = blk_mq_poll_nsecs(q, hctx, rw);
+	if (!nsecs)
+		return false;
+
+	hctx->poll_sleep++;
+
+	/*
+	 * The caller has already set the task state, so a completion
+	 * arriving before we get to sleep will make io_schedule() return
+	 * right away.
+	 */
+	hrtimer_init_on_stack(&hs.timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	hrtimer_set_expires(&hs.timer, ns_to_ktime(nsecs));
+	hrtimer_init_sleeper(&hs, current);
+	hrtimer_start_expires(&hs.timer, HRTIMER_MODE_REL);
+	if (hs.task)
+		io_schedule();
+	hrtimer_cancel(&hs.timer);
+	destroy_hrtimer_on_stack(&hs.timer);
+
+	__set_current_state(TASK_RUNNING);
+	return true;
+}
+
+/**
+ * blk_poll - poll a hardware queue for completions
+ * @q:		the request queue the I/O was submitted to
+ * @rw:		data direction of the I/O being waited for
+ * @may_sleep:	allow a hybrid sleep before spinning
+ *
+ * Description:
+ *	Spins on the hardware queue mapped to the current CPU until a
+ *	completion is found or the caller has been woken up.  The caller
+ *	must set its task state before calling, just as it would before
+ *	io_schedule(), and must re-check its wait condition whenever this
+ *	returns true.  If @may_sleep is set and hybrid polling is enabled,
+ *	the first call sleeps for part of the expected completion time and
+ *	returns; subsequent calls should pass false to spin.
+ *
+ *	Returns false if polling is not possible, in which case the caller
+ *	should fall back to sleeping.
+ */
+bool blk_poll(struct request_queue *q, int rw, bool may_sleep)
+{
+	struct blk_mq_hw_ctx *hctx;
+	struct blk_plug *plug;
+
+	if (!q->mq_ops || !q->mq_ops->poll || !blk_queue_poll(q))
+		return false;
+
+	plug = current->plug;
+	if (plug)
+		blk_flush_plug_list(plug, false);
+
+	hctx = q->mq_ops->map_queue(q, raw_smp_processor_id());
+	hctx->poll_considered++;
+
+	if (may_sleep && blk_mq_poll_hybrid_sleep(q, hctx, rw))
+		return true;
+
+	while (!need_resched()) {
+		int ret;
+
+		hctx->poll_invoked++;
+
+		ret = q->mq_ops->poll(hctx);
+		if (ret > 0) {
+			hctx->poll_success++;
+			set_current_state(TASK_RUNNING);
+			return true;
+		}
+
+		if (signal_pending_state(current->state, current))
+			set_current_state(TASK_RUNNING);
+
+		if (current->state == TASK_RUNNING)
+			return true;
+		if (ret < 0)
+			break;
+		cpu_relax();
+	}
+
+	return false;
+}
+EXPORT_SYMBOL_GPL(blk_poll);
+
 /*
  * Default mapping to a software queue, since we use one per CPU.
  */
@@ -1980,6 +2134,7 @@ struct request_queue *blk_mq_init_allocated_queue(struct blk_mq_tag_set *set,
 		q->queue_flags |= 1 << QUEUE_FLAG_NO_SG_MERGE;
 
 	q->sg_reserved_size = INT_MAX;
+	q->poll_nsec = -1;
 
 	INIT_WORK(&q->requeue_work, blk_mq_requeue_work);
 	INIT_LIST_HEAD(&q->requeue_list);
@@ -24,11 +24,13 @@
 #include <linux/file.h>
 #include <linux/list.h>
 #include <linux/async.h>
+#include <linux/boot_timeline.h>
 #include <linux/pm.h>
 #include <linux/suspend.h>
 #include <linux/syscore_ops.h>
 #include <linux/reboot.h>
 #include <linux/security.h>
+#include <linux/lzo.h>
 
 #include <generated/utsrelease.h>
 
@@ -142,6 +144,12 @@ struct firmware_buf {
 	unsigned long status;
 	void *data;
 	size_t size;
+#ifdef CONFIG_FW_CACHE_COMPRESS
+	/* while only the cache holds it, data is replaced by this */
+	void *zdata;
+	size_t zsize;
+	bool incompressible;
+#endif
 #ifdef CONFIG_FW_LOADER_USER_HELPER
 	bool is_paged_buf;
 	bool need_uevent;
@@ -257,6 +265,9 @@ static void __fw_free_buf(struct kref *ref)
 	} else
 #endif
 		vfree(buf->data);
+#ifdef CONFIG_FW_CACHE_COMPRESS
+	vfree(buf->zdata);
+#endif
 	kfree(buf);
 }
 
@@ -983,7 +994,59 @@ static inline void kill_requests_without_uevent(void) { }
 #endif /* CONFIG_FW_LOADER_USER_HELPER */
 
 
-/* wait until the shared firmware_buf becomes ready (or error) */
+#ifdef CONFIG_FW_CACHE_COMPRESS
+/* Uncompress a cached image for a new user: fw_lock */
+static int fw_buf_inflate(struct firmware_buf *buf)
+{
+	size_t len = buf->size;
+	void *data;
+	int ret;
+
+	if (!buf->zdata)
+		return 0;
+
+	data = vmalloc(buf->size);
+	if (!data) {
+		ret = -ENOMEM;
+		goto drop;
+	}
+
+	ret = lzo1x_decompress_safe(buf->zdata, buf->zsize, data, &len);
+	if (ret != LZO_E_OK || len != buf->size) {
+		pr_err("%s: fw-%s corrupted in cache (%d)\n", __func__,
+		       buf->fw_id, ret);
+		vfree(data);
+		ret = -EIO;
+		goto drop;
+	}
+
+	vfree(buf->zdata);
+	buf->zdata = NULL;
+	buf->data = data;
+	return 0;
+
+drop:
+	/*
+	 * Forget the cached copy and make the image pending again, so that
+	 * it is loaded from the filesystem like the first time.
+	 */
+	vfree(buf->zdata);
+	buf->zdata = NULL;
+	clear_bit(FW_STATUS_DONE, &buf->status);
+	reinit_completion(&buf->completion);
+	return ret;
+}
+#else
+static inline int fw_buf_inflate(struct firmware_buf *buf)
+{
+	return 0;
+}
+#endif
+
+/*
+ * wait until the shared firmware_buf becomes ready (or error); returns 1
+ * if its cached copy was lost and the image has to be loaded again
+ */
 static int sync_cached_firmware_buf(struct firmware_buf *buf)
 {
 	int ret = 0;
@@ -998,6 +1061,8 @@ static int sync_cached_firmware_buf(struct firmware_buf *buf)
 		ret = wait_for_completion_interruptible(&buf->completion);
 		mutex_lock(&fw_lock);
 	}
+	if (!ret && fw_buf_inflate(buf))
+		ret = 1;
 	mutex_unlock(&fw_lock);
 	return ret;
 }
@@ -1091,7 +1156,7 @@ _request_firmware(const struct firmware **firmware_p, const char *name,
 {
 	struct firmware *fw;
 	long timeout;
-	int ret;
+	int ret, event;
 
 	if (!firmware_p)
 		return -EINVAL;
@@ -1099,6 +1164,7 @@ _request_firmware(const struct firmware **firmware_p, const char *name,
 	if (!name || name[0] == '\0')
 		return -EINVAL;
 
+	event = boot_timeline_begin(BOOT_EVENT_FIRMWARE, "%s", name);
 	ret = _request_firmware_prepare(&fw, name, device);
 	if (ret <= 0) /* error or already assigned */
 		goto out;
@@ -1146,6 +1212,7 @@ _request_firmware(const struct firmware **firmware_p, const char *name,
 		fw = NULL;
 	}
 
+	boot_timeline_end(event, ret);
 	*firmware_p = fw;
 	return ret;
 }
@@ -1209,6 +1276,102 @@ int request_firmware_direct(const struct firmware **firmware_p,
 }
 EXPORT_SYMBOL_GPL(request_firmware_direct);
 
+static ssize_t fw_read_file_chunk(struct file *file, void *buf, size_t size,
+				  loff_t offset)
+{
+	loff_t fsize;
+	int rc;
+
+	if (!S_ISREG(file_inode(file)->i_mode))
+		return -EINVAL;
+	fsize = i_size_read(file_inode(file));
+	if (offset >= fsize)
+		return 0;
+	size = min_t(loff_t, size, fsize - offset);
+
+	rc = kernel_read(file, offset, buf, size);
+	if (rc != size)
+		return rc < 0 ? rc : -EIO;
+
+	rc = security_kernel_fw_from_file(file, buf, size);
+	return rc ? rc : size;
+}
+
+/**
+ * request_firmware_chunk: - read part of a firmware image
+ * @name: name of firmware file
+ * @device: device for which firmware is being loaded
+ * @buf: buffer to read into
+ * @size: size of @buf
+ * @offset: offset into the firmware image
+ *
+ * For drivers that feed firmware to their device a piece at a time: this
+ * reads up to @size bytes at @offset straight into @buf, without loading
+ * or caching the whole image.  Built-in firmware is used if present,
+ * otherwise the image is read from the filesystem; the user helper is
+ * never used.
+ *
+ * Returns the number of bytes read, 0 at or past the end of the image,
+ * or a negative error code.
+ **/
+ssize_t request_firmware_chunk(const char *name, struct device *device,
+			       void *buf, size_t size, loff_t offset)
+{
+	struct firmware builtin;
+	ssize_t rc = -ENOENT;
+	char *path;
+	int i;
+
+	if (!name || name[0] == '\0' || offset < 0)
+		return -EINVAL;
+
+	if (fw_get_builtin_firmware(&builtin, name)) {
+		if (offset >= builtin.size)
+			return 0;
+		size = min_t(size_t, size, builtin.size - offset);
+		memcpy(buf, builtin.data + offset, size);
+		return size;
+	}
+
+	if (WARN_ON(usermodehelper_read_trylock()))
+		return -EBUSY;
+
+	path = __getname();
+	if (!path) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(fw_path); i++) {
+		struct file *file;
+
+		/* skip the unset customized path */
+		if (!fw_path[i][0])
+			continue;
+
+		snprintf(path, PATH_MAX, "%s/%s", fw_path[i], name);
+
+		file = filp_open(path, O_RDONLY, 0);
+		if (IS_ERR(file))
+			continue;
+		rc = fw_read_file_chunk(file, buf, size, offset);
+		fput(file);
+		if (rc < 0)
+			dev_warn(device, "firmware, attempted to read %s, but failed with error %zd\n",
+				 path, rc);
+		else
+			break;
+	}
+	__putname(path);
+out:
+	usermodehelper_read_unlock();
+	if (rc < 0)
+		dev_dbg(device, "firmware: reading %s at %lld failed with error %zd\n",
+			name, offset, rc);
+	return rc;
+}
+EXPORT_SYMBOL_GPL(request_firmware_chunk);
+
 /**
  * release_firmware: - release the resource associated with a firmware image
  * @fw: firmware resource to release
@@ -1520,6 +1683,96 @@ static void __device_uncache_fw_images(void)
 	spin_unlock(&fwc->name_lock);
 }
 
+#ifdef CONFIG_FW_CACHE_COMPRESS
+/* Compress one image nobody but the cache uses: fw_lock */
+static void fw_buf_deflate(struct firmware_buf *buf, void *wrkmem)
+{
+	size_t zsize = lzo1x_worst_compress(buf->size);
+	void *zbuf, *zdata;
+
+	/* whatever goes wrong, don't try again on every suspend */
+	buf->incompressible = true;
+
+	zbuf = vmalloc(zsize);
+	if (!zbuf)
+		return;
+
+	if (lzo1x_1_compress(buf->data, buf->size, zbuf, &zsize,
+			     wrkmem) != LZO_E_OK)
+		goto out;
+
+	/* not worth a decompression on every cache hit */
+	if (zsize > buf->size - buf->size / 8)
+		goto out;
+
+	zdata = vmalloc(zsize);
+	if (!zdata)
+		goto out;
+	memcpy(zdata, zbuf, zsize);
+
+	pr_debug("%s: fw-%s %zu -> %zu bytes\n", __func__, buf->fw_id,
+		 buf->size, zsize);
+
+	vfree(buf->data);
+	buf->data = NULL;
+	buf->zdata = zdata;
+	buf->zsize = zsize;
+	buf->incompressible = false;
+out:
+	vfree(zbuf);
+}
+
+/* Find a cached image held only by the cache and take a reference */
+static struct firmware_buf *fw_cache_next_idle(struct firmware_cache *fwc)
+{
+	struct firmware_buf *buf;
+
+	spin_lock(&fwc->lock);
+	list_for_each_entry(buf, &fwc->head, list) {
+		if (atomic_read(&buf->ref.refcount) != 1 || !buf->data ||
+		    buf->incompressible ||
+		    !test_bit(FW_STATUS_DONE, &buf->status))
+			continue;
+#ifdef CONFIG_FW_LOADER_USER_HELPER
+		if (buf->is_paged_buf)
+			continue;
+#endif
+		kref_get(&buf->ref);
+		spin_unlock(&fwc->lock);
+		return buf;
+	}
+	spin_unlock(&fwc->lock);
+	return NULL;
+}
+
+/*
+ * Once the images are cached for a system sleep transition no driver
+ * holds most of them, so keep those compressed until they are requested
+ * again.  New requests for an image uncompress it under fw_lock before
+ * they can see its data.
+ */
+static void fw_cache_compress(struct firmware_cache *fwc)
+{
+	struct firmware_buf *buf;
+	void *wrkmem;
+
+	wrkmem = vmalloc(LZO1X_1_MEM_COMPRESS);
+	if (!wrkmem)
+		return;
+
+	mutex_lock(&fw_lock);
+	while ((buf = fw_cache_next_idle(fwc))) {
+		fw_buf_deflate(buf, wrkmem);
+		fw_free_buf(buf);
+	}
+	mutex_unlock(&fw_lock);
+
+	vfree(wrkmem);
+}
+#else
+static inline void fw_cache_compress(struct firmware_cache *fwc) { }
+#endif
+
 /**
  * device_cache_fw_images - cache devices' firmware
  *
@@ -1560,6 +1813,8 @@ static void device_cache_fw_images(void)
 	/* wait for completion of caching firmware for all devices */
 	async_synchronize_full_domain(&fw_cache_domain);
 
+	fw_cache_compress(fwc);
+
 	loading_timeout = old_timeout;
 }
 
@@ -17,6 +17,7 @@ struct nullb_cmd {
 	struct bio *bio;
 	unsigned int tag;
 	struct nullb_queue *nq;
+	u64 deadline;
 };
 
 struct nullb_queue {
@@ -24,6 +25,9 @@ struct nullb_queue {
 	wait_queue_head_t wait;
 	unsigned int queue_depth;
 
+	struct llist_head poll_list;
+	struct hrtimer poll_timer;
+
 	struct nullb_cmd *cmds;
 };
 
@@ -147,6 +151,10 @@ static bool use_per_node_hctx = false;
 module_param(use_per_node_hctx, bool, S_IRUGO);
 MODULE_PARM_DESC(use_per_node_hctx, "Use per-node allocation for hardware context queues. Default: false");
 
+static bool use_poll;
+module_param(use_poll, bool, S_IRUGO);
+MODULE_PARM_DESC(use_poll, "Complete requests through blk-mq polling, with a timer as fallback (queue_mode=2 only). Default: false");
+
 static void put_tag(struct nullb_queue *nq, unsigned int tag)
 {
 	clear_bit_unlock(tag, nq->tag_map);
@@ -263,6 +271,69 @@ static void null_cmd_end_timer(struct nullb_cmd *cmd)
 	put_cpu();
 }
 
+/*
+ * Reap commands whose completion time has passed from the poll list,
+ * putting the rest back.  Called both from ->poll() and from the
+ * fallback timer, which stands in for the device interrupt.
+ */
+static int null_reap_poll_list(struct nullb_queue *nq)
+{
+	struct llist_node *entry;
+	struct nullb_cmd *cmd;
+	u64 now = ktime_get_ns();
+	int found = 0;
+
+	entry = llist_del_all(&nq->poll_list);
+	while (entry) {
+		cmd = container_of(entry, struct nullb_cmd, ll_list);
+		entry = entry->next;
+		if (cmd->deadline <= now) {
+			end_cmd(cmd);
+			found++;
+		} else if (llist_add(&cmd->ll_list, &nq->poll_list)) {
+			/* the timer may have found the list empty meanwhile */
+			hrtimer_start(&nq->poll_timer,
+				      ktime_set(0, cmd->deadline - now),
+				      HRTIMER_MODE_REL);
+		}
+	}
+
+	return found;
+}
+
+static enum hrtimer_restart null_poll_timer_expired(struct hrtimer *timer)
+{
+	struct nullb_queue *nq = container_of(timer, struct nullb_queue,
+					      poll_timer);
+
+	null_reap_poll_list(nq);
+	if (!llist_empty(&nq->poll_list))
+		hrtimer_start(&nq->poll_timer, ktime_set(0, completion_nsec),
+				HRTIMER_MODE_REL);
+
+	return HRTIMER_NORESTART;
+}
+
+static void null_cmd_end_poll(struct nullb_cmd *cmd)
+{
+	struct nullb_queue *nq = cmd->nq;
+
+	cmd->deadline = ktime_get_ns() + completion_nsec;
+	if (llist_add(&cmd->ll_list, &nq->poll_list))
+		hrtimer_start(&nq->poll_timer, ktime_set(0, completion_nsec),
+				HRTIMER_MODE_REL);
+}
+
+static int null_poll(struct blk_mq_hw_ctx *hctx)
+{
+	struct nullb_queue *nq = hctx->driver_data;
+
+	if (!use_poll)
+		return -1;
+
+	return null_reap_poll_list(nq);
+}
+
 static void null_softirq_done_fn(struct request *rq)
 {
 	if (queue_mode == NULL_Q_MQ)
@@ -273,6 +344,11 @@ static void null_softirq_done_fn(struct request *rq)
 
 static inline void null_handle_cmd(struct nullb_cmd *cmd)
 {
+	if (use_poll && queue_mode == NULL_Q_MQ) {
+		null_cmd_end_poll(cmd);
+		return;
+	}
+
 	/* Complete IO by inline, softirq or timer */
 	switch (irqmode) {
 	case NULL_IRQ_SOFTIRQ:
@@ -372,6 +448,10 @@ static void null_init_queue(struct nullb *nullb, struct nullb_queue *nq)
 
 	init_waitqueue_head(&nq->wait);
 	nq->queue_depth = nullb->queue_depth;
+
+	init_llist_head(&nq->poll_list);
+	hrtimer_init(&nq->poll_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	nq->poll_timer.function = null_poll_timer_expired;
 }
 
 static int null_init_hctx(struct blk_mq_hw_ctx *hctx, void *data,
@@ -392,14 +472,19 @@ static struct blk_mq_ops null_mq_ops = {
 	.map_queue      = blk_mq_map_queue,
 	.init_hctx	= null_init_hctx,
 	.complete	= null_softirq_done_fn,
+	.poll		= null_poll,
 };
 
 static void null_del_dev(struct nullb *nullb)
 {
+	int i;
+
 	list_del_init(&nullb->list);
 
 	del_gendisk(nullb->disk);
 	blk_cleanup_queue(nullb->q);
+	for (i = 0; i < nullb->nr_queues; i++)
+		hrtimer_cancel(&nullb->queues[i].poll_timer);
 	if (queue_mode == NULL_Q_MQ)
 		blk_mq_free_tag_set(&nullb->tag_set);
 	put_disk(nullb->disk);
@@ -560,6 +645,8 @@ static int null_add_dev(void)
 	nullb->q->queuedata = nullb;
 	queue_flag_set_unlocked(QUEUE_FLAG_NONROT, nullb->q);
 	queue_flag_clear_unlocked(QUEUE_FLAG_ADD_RANDOM, nullb->q);
+	if (use_poll && queue_mode == NULL_Q_MQ)
+		queue_flag_set_unlocked(QUEUE_FLAG_POLL, nullb->q);
 
 	disk = nullb->disk = alloc_disk_node(1, home_node);
 	if (!disk) {
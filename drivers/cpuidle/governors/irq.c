@@ -0,0 +1,152 @@
+/*
+ * irq.c - the interrupt history idle governor
+ *
+ * This code is licenced under the GPL version 2 as described
+ * in the COPYING file that acompanies the Linux Kernel.
+ */
+
+#include <linux/kernel.h>
+#include <linux/cpuidle.h>
+#include <linux/interrupt.h>
+#include <linux/pm_qos.h>
+#include <linux/ktime.h>
+#include <linux/tick.h>
+#include <linux/sched.h>
+#include <linux/math64.h>
+#include <linux/module.h>
+
+#include <trace/events/power.h>
+
+/*
+ * Like the menu governor, this one starts from the time until the next
+ * timer event.  Rather than learning from past idle periods how much
+ * earlier than that the CPU tends to be woken, it looks at the interrupts
+ * the CPU has recently handled: most wakeups that are not timers are
+ * device interrupts, and many devices interrupt at a fairly regular
+ * interval.  irq_timings_next_event() assumes each of them keeps doing so
+ * and tells when the first is next due.  The expected idle time is the
+ * earlier of the two, and the deepest state whose target residency fits
+ * in it (and whose exit latency is tolerated) is picked.
+ *
+ * How good the guess was is reported by the cpu_idle_predict tracepoint
+ * after every idle period; tools/power/cpuidle/idle-replay replays a
+ * recording of it offline.
+ *
+ * The rating is below menu's, so the governor is only used once it is
+ * picked through current_governor (boot with cpuidle_sysfs_switch).
+ */
+
+struct irq_gov_device {
+	int		last_state_idx;
+
+	unsigned int	next_timer_us;
+	unsigned int	next_irq_us;
+};
+
+static DEFINE_PER_CPU(struct irq_gov_device, irq_gov_devices);
+
+/**
+ * irq_gov_select - selects the next idle state to enter
+ * @drv: cpuidle driver containing state data
+ * @dev: the CPU
+ */
+static int irq_gov_select(struct cpuidle_driver *drv, struct cpuidle_device *dev)
+{
+	struct irq_gov_device *data = this_cpu_ptr(&irq_gov_devices);
+	int latency_req = pm_qos_request(PM_QOS_CPU_DMA_LATENCY);
+	unsigned int predicted_us;
+	u64 now, next_irq;
+	int i;
+
+	data->last_state_idx = CPUIDLE_DRIVER_STATE_START - 1;
+	data->next_timer_us = ktime_to_us(tick_nohz_get_sleep_length());
+	data->next_irq_us = UINT_MAX;
+
+	/* Special case when user has set very strict latency requirement */
+	if (unlikely(latency_req == 0))
+		return 0;
+
+	now = local_clock();
+	next_irq = irq_timings_next_event(now);
+	if (next_irq != U64_MAX)
+		data->next_irq_us = min_t(u64, div_u64(next_irq - now,
+						       NSEC_PER_USEC),
+					  UINT_MAX);
+
+	predicted_us = min(data->next_timer_us, data->next_irq_us);
+
+	/*
+	 * We want to default to C1 (hlt), not to busy polling
+	 * unless the timer is happening really really soon.
+	 */
+	if (data->next_timer_us > 5 &&
+	    !drv->states[CPUIDLE_DRIVER_STATE_START].disabled &&
+	    dev->states_usage[CPUIDLE_DRIVER_STATE_START].disable == 0)
+		data->last_state_idx = CPUIDLE_DRIVER_STATE_START;
+
+	for (i = CPUIDLE_DRIVER_STATE_START; i < drv->state_count; i++) {
+		struct cpuidle_state *s = &drv->states[i];
+		struct cpuidle_state_usage *su = &dev->states_usage[i];
+
+		if (s->disabled || su->disable)
+			continue;
+		if (s->target_residency > predicted_us)
+			continue;
+		if (s->exit_latency > latency_req)
+			continue;
+
+		data->last_state_idx = i;
+	}
+
+	return data->last_state_idx;
+}
+
+/**
+ * irq_gov_reflect - reports how the prediction turned out
+ * @dev: the CPU
+ * @index: the index of actual entered state
+ */
+static void irq_gov_reflect(struct cpuidle_device *dev, int index)
+{
+	struct irq_gov_device *data = this_cpu_ptr(&irq_gov_devices);
+
+	data->last_state_idx = index;
+	if (index >= 0)
+		trace_cpu_idle_predict_rcuidle(dev->cpu, index,
+					       data->next_timer_us,
+					       data->next_irq_us,
+					       cpuidle_get_last_residency(dev));
+}
+
+/**
+ * irq_gov_enable_device - scans a CPU's states and does setup
+ * @drv: cpuidle driver
+ * @dev: the CPU
+ */
+static int irq_gov_enable_device(struct cpuidle_driver *drv,
+				 struct cpuidle_device *dev)
+{
+	struct irq_gov_device *data = &per_cpu(irq_gov_devices, dev->cpu);
+
+	memset(data, 0, sizeof(struct irq_gov_device));
+	return 0;
+}
+
+static struct cpuidle_governor irq_governor = {
+	.name =		"irq",
+	.rating =	15,
+	.enable =	irq_gov_enable_device,
+	.select =	irq_gov_select,
+	.reflect =	irq_gov_reflect,
+	.owner =	THIS_MODULE,
+};
+
+/**
+ * init_irq_gov - initializes the governor
+ */
+static int __init init_irq_gov(void)
+{
+	return cpuidle_register_governor(&irq_governor);
+}
+
+postcore_initcall(init_irq_gov);
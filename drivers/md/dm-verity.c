@@ -32,6 +32,7 @@
 
 #define DM_VERITY_MAX_LEVELS		63
 #define DM_VERITY_MAX_CORRUPTED_ERRS	100
+#define DM_VERITY_MAX_MB_MSGS		4
 
 #define DM_VERITY_OPT_LOGGING		"ignore_corruption"
 #define DM_VERITY_OPT_RESTART		"restart_on_corruption"
@@ -72,6 +73,7 @@ struct dm_verity {
 	unsigned char version;
 	unsigned digest_size;	/* digest size for the current hash algorithm */
 	unsigned shash_descsize;/* the size of temporary space for crypto */
+	unsigned mb_max_msgs;	/* data blocks hashed together */
 	int hash_failed;	/* set to 1 if hash of any block failed */
 	enum verity_mode mode;	/* mode for handling verification errors */
 	unsigned corrupted_errs;/* Number of errors for corrupted blocks */
@@ -102,10 +104,12 @@ struct dm_verity_io {
 	 * Three variably-size fields follow this struct:
 	 *
 	 * u8 hash_desc[v->shash_descsize];
-	 * u8 real_digest[v->digest_size];
-	 * u8 want_digest[v->digest_size];
+	 * u8 real_digest[v->digest_size * v->mb_max_msgs];
+	 * u8 want_digest[v->digest_size * v->mb_max_msgs];
 	 *
 	 * To access them use: io_hash_desc(), io_real_digest() and io_want_digest().
+	 * Only the first digest of each array is used, except when several data
+	 * blocks are hashed together by verity_verify_blocks_mb().
 	 */
 };
 
@@ -128,7 +132,8 @@ static u8 *io_real_digest(struct dm_verity *v, struct dm_verity_io *io)
 
 static u8 *io_want_digest(struct dm_verity *v, struct dm_verity_io *io)
 {
-	return (u8 *)(io + 1) + v->shash_descsize + v->digest_size;
+	return (u8 *)(io + 1) + v->shash_descsize +
+	       v->digest_size * v->mb_max_msgs;
 }
 
 /*
@@ -345,6 +350,121 @@ release_ret_r:
 	return r;
 }
 
+/*
+ * Fill io_want_digest(v, io) with the expected hash of a data block,
+ * verifying the hash tree on the way as necessary.
+ */
+static int verity_get_want_digest(struct dm_verity_io *io, sector_t block)
+{
+	struct dm_verity *v = io->v;
+	int i;
+
+	if (likely(v->levels)) {
+		/*
+		 * First, we try to get the requested hash for
+		 * the current block. If the hash block itself is
+		 * verified, zero is returned. If it isn't, this
+		 * function returns 0 and we fall back to whole
+		 * chain verification.
+		 */
+		int r = verity_verify_level(io, block, 0, true);
+		if (likely(!r))
+			return 0;
+		if (r < 0)
+			return r;
+	}
+
+	memcpy(io_want_digest(v, io), v->root_digest, v->digest_size);
+
+	for (i = v->levels - 1; i >= 0; i--) {
+		int r = verity_verify_level(io, block, i, false);
+		if (unlikely(r))
+			return r;
+	}
+
+	return 0;
+}
+
+/*
+ * Verify the next "n" data blocks of the io at once, with the hash driver
+ * interleaving the computations.  Each block must be contiguous in a single
+ * bio vector; if one is not, 1 is returned and nothing is consumed.
+ */
+static int verity_verify_blocks_mb(struct dm_verity_io *io, struct bio *bio,
+				   unsigned b, unsigned n)
+{
+	struct dm_verity *v = io->v;
+	unsigned block_size = 1 << v->data_dev_block_bits;
+	struct bvec_iter iter = io->iter;
+	struct page *pages[DM_VERITY_MAX_MB_MSGS];
+	const u8 *data[DM_VERITY_MAX_MB_MSGS];
+	u8 *results[DM_VERITY_MAX_MB_MSGS];
+	struct shash_desc *desc;
+	unsigned offsets[DM_VERITY_MAX_MB_MSGS];
+	int i, r;
+
+	for (i = 0; i < n; i++) {
+		struct bio_vec bv = bio_iter_iovec(bio, iter);
+
+		if (bv.bv_len < block_size)
+			return 1;
+		pages[i] = bv.bv_page;
+		offsets[i] = bv.bv_offset;
+		bio_advance_iter(bio, &iter, block_size);
+	}
+
+	/* the tree walk reuses the first slot, so fill it last */
+	for (i = n - 1; i >= 0; i--) {
+		r = verity_get_want_digest(io, io->block + b + i);
+		if (unlikely(r))
+			return r;
+		if (i)
+			memcpy(io_want_digest(v, io) + i * v->digest_size,
+			       io_want_digest(v, io), v->digest_size);
+		results[i] = io_real_digest(v, io) + i * v->digest_size;
+	}
+
+	desc = io_hash_desc(v, io);
+	desc->tfm = v->tfm;
+	desc->flags = CRYPTO_TFM_REQ_MAY_SLEEP;
+	r = crypto_shash_init(desc);
+	if (r < 0) {
+		DMERR("crypto_shash_init failed: %d", r);
+		return r;
+	}
+
+	r = crypto_shash_update(desc, v->salt, v->salt_size);
+	if (r < 0) {
+		DMERR("crypto_shash_update failed: %d", r);
+		return r;
+	}
+
+	for (i = 0; i < n; i++)
+		data[i] = (u8 *)kmap_atomic(pages[i]) + offsets[i];
+	r = crypto_shash_finup_mb(desc, data, block_size, results, n);
+	for (i = n - 1; i >= 0; i--)
+		kunmap_atomic((void *)(data[i] - offsets[i]));
+
+	if (r < 0) {
+		DMERR("crypto_shash_finup_mb failed: %d", r);
+		return r;
+	}
+
+	io->iter = iter;
+
+	for (i = 0; i < n; i++) {
+		if (unlikely(memcmp(results[i],
+				    io_want_digest(v, io) + i * v->digest_size,
+				    v->digest_size))) {
+			if (verity_handle_err(v, DM_VERITY_BLOCK_TYPE_DATA,
+					      io->block + b + i))
+				return -EIO;
+		}
+	}
+
+	return 0;
+}
+
 /*
  * Verify one "dm_verity_io" structure.
  */
@@ -354,7 +474,6 @@ static int verity_verify_io(struct dm_verity_io *io)
 	struct bio *bio = dm_bio_from_per_bio_data(io,
 						   v->ti->per_bio_data_size);
 	unsigned b;
-	int i;
 
 	for (b = 0; b < io->n_blocks; b++) {
 		struct shash_desc *desc;
@@ -362,30 +481,24 @@ static int verity_verify_io(struct dm_verity_io *io)
 		int r;
 		unsigned todo;
 
-		if (likely(v->levels)) {
-			/*
-			 * First, we try to get the requested hash for
-			 * the current block. If the hash block itself is
-			 * verified, zero is returned. If it isn't, this
-			 * function returns 0 and we fall back to whole
-			 * chain verification.
-			 */
-			int r = verity_verify_level(io, io->block + b, 0, true);
-			if (likely(!r))
-				goto test_block_hash;
+		/* salted format v1 hashes share the salt prefix */
+		if (v->mb_max_msgs > 1 && likely(v->version >= 1) &&
+		    io->n_blocks - b >= 2) {
+			unsigned n = min(io->n_blocks - b, v->mb_max_msgs);
+
+			r = verity_verify_blocks_mb(io, bio, b, n);
 			if (r < 0)
 				return r;
+			if (!r) {
+				b += n - 1;
+				continue;
+			}
 		}
 
-		memcpy(io_want_digest(v, io), v->root_digest, v->digest_size);
-
-		for (i = v->levels - 1; i >= 0; i--) {
-			int r = verity_verify_level(io, io->block + b, i, false);
-			if (unlikely(r))
-				return r;
-		}
+		r = verity_get_want_digest(io, io->block + b);
+		if (unlikely(r))
+			return r;
 
-test_block_hash:
 		desc = io_hash_desc(v, io);
 		desc->tfm = v->tfm;
 		desc->flags = CRYPTO_TFM_REQ_MAY_SLEEP;
@@ -850,6 +963,8 @@ static int verity_ctr(struct dm_target *ti, unsigned argc, char **argv)
 	}
 	v->shash_descsize =
 		sizeof(struct shash_desc) + crypto_shash_descsize(v->tfm);
+	v->mb_max_msgs = clamp_t(unsigned, crypto_shash_mb_max_msgs(v->tfm),
+				 1, DM_VERITY_MAX_MB_MSGS);
 
 	v->root_digest = kmalloc(v->digest_size, GFP_KERNEL);
 	if (!v->root_digest) {
@@ -960,7 +1075,7 @@ static int verity_ctr(struct dm_target *ti, unsigned argc, char **argv)
 		goto bad;
 	}
 
-	ti->per_bio_data_size = roundup(sizeof(struct dm_verity_io) + v->shash_descsize + v->digest_size * 2, __alignof__(struct dm_verity_io));
+	ti->per_bio_data_size = roundup(sizeof(struct dm_verity_io) + v->shash_descsize + v->digest_size * 2 * v->mb_max_msgs, __alignof__(struct dm_verity_io));
 
 	v->vec_mempool = mempool_create_kmalloc_pool(DM_VERITY_MEMPOOL_SIZE,
 					BIO_MAX_PAGES * sizeof(struct bio_vec));
@@ -1055,6 +1055,74 @@ int of_modalias_node(struct device_node *node, char *modalias, int len)
 }
 EXPORT_SYMBOL_GPL(of_modalias_node);
 
+/*
+ * Nodes indexed by phandle, masked to the size of the table.  dtc numbers
+ * phandles from 1 upwards, so with the table sized to the number of
+ * phandles in the boot tree nearly every lookup hits.  On a miss (a
+ * collision, or a node added later by an overlay) the tree is walked as
+ * before and the slot refilled.  Protected by devtree_lock.
+ */
+static struct device_node **phandle_cache;
+static u32 phandle_cache_mask;
+
+static inline bool phandle_cacheable(phandle handle)
+{
+	return handle && handle != OF_PHANDLE_ILLEGAL;
+}
+
+void __of_phandle_cache_add(struct device_node *np)
+{
+	if (phandle_cache && phandle_cacheable(np->phandle))
+		phandle_cache[np->phandle & phandle_cache_mask] = np;
+}
+
+void __of_phandle_cache_remove(struct device_node *np)
+{
+	struct device_node **slot;
+
+	if (!phandle_cache)
+		return;
+
+	slot = &phandle_cache[np->phandle & phandle_cache_mask];
+	if (*slot == np)
+		*slot = NULL;
+}
+
+/**
+ * of_populate_phandle_cache - Index the nodes of the tree by phandle
+ *
+ * Called once the tree has been unflattened, after which
+ * of_find_node_by_phandle() no longer needs to walk the whole tree.
+ *
+ * @dt_alloc:	An allocator that provides a virtual address to memory
+ *		for the cache
+ */
+void of_populate_phandle_cache(void * (*dt_alloc)(u64 size, u64 align))
+{
+	struct device_node **cache, *np;
+	unsigned long flags;
+	u32 count = 0;
+
+	for_each_of_allnodes(np)
+		if (phandle_cacheable(np->phandle))
+			count++;
+	if (!count)
+		return;
+
+	count = roundup_pow_of_two(count);
+	cache = dt_alloc(count * sizeof(*cache), __alignof__(*cache));
+	if (!cache)
+		return;
+	memset(cache, 0, count * sizeof(*cache));
+
+	raw_spin_lock_irqsave(&devtree_lock, flags);
+	phandle_cache = cache;
+	phandle_cache_mask = count - 1;
+	for_each_of_allnodes(np)
+		__of_phandle_cache_add(np);
+	raw_spin_unlock_irqrestore(&devtree_lock, flags);
+}
+
 /**
  * of_find_node_by_phandle - Find a node given a phandle
  * @handle:	phandle of the node to find
@@ -1071,9 +1139,18 @@ struct device_node *of_find_node_by_phandle(phandle handle)
 		return NULL;
 
 	raw_spin_lock_irqsave(&devtree_lock, flags);
+	if (phandle_cache) {
+		np = phandle_cache[handle & phandle_cache_mask];
+		if (np && np->phandle == handle)
+			goto out;
+	}
+
 	for_each_of_allnodes(np)
 		if (np->phandle == handle)
 			break;
+	if (np)
+		__of_phandle_cache_add(np);
+out:
 	of_node_get(np);
 	raw_spin_unlock_irqrestore(&devtree_lock, flags);
 	return np;
@@ -233,6 +233,8 @@ void __of_attach_node(struct device_node *np)
 	np->sibling = np->parent->child;
 	np->parent->child = np;
 	of_node_clear_flag(np, OF_DETACHED);
+
+	__of_phandle_cache_add(np);
 }
 
 /**
@@ -281,6 +283,7 @@ void __of_detach_node(struct device_node *np)
 		prevsib->sibling = np->sibling;
 	}
 
+	__of_phandle_cache_remove(np);
 	of_node_set_flag(np, OF_DETACHED);
 }
 
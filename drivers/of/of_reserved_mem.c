@@ -291,3 +291,76 @@ void of_reserved_mem_device_release(struct device *dev)
 	rmem->ops->device_release(rmem, dev);
 }
 EXPORT_SYMBOL_GPL(of_reserved_mem_device_release);
+
+/*
+ * Regions handed over by the previous kernel across kexec, see
+ * kexec_preserve_region().  They stay reserved until their owner picks
+ * them up with of_reserved_mem_lookup_preserved() and hands them back
+ * with of_reserved_mem_release_preserved().
+ */
+static const struct reserved_mem_ops rmem_kexec_preserved_ops;
+
+static int __init rmem_kexec_preserved_setup(struct reserved_mem *rmem)
+{
+	unsigned long node = rmem->fdt_node;
+	const char *label;
+
+	label = of_get_flat_dt_prop(node, "label", NULL);
+	if (!label || of_get_flat_dt_prop(node, "no-map", NULL) ||
+	    !PAGE_ALIGNED(rmem->base) || !PAGE_ALIGNED(rmem->size))
+		return -EINVAL;
+
+	rmem->ops = &rmem_kexec_preserved_ops;
+	rmem->priv = (void *)label;
+
+	pr_info("Reserved memory: %s preserved across kexec at %pa, size %ld KiB\n",
+		label, &rmem->base, (unsigned long)rmem->size / SZ_1K);
+
+	return 0;
+}
+RESERVEDMEM_OF_DECLARE(kexec_preserved, "linux,kexec-preserved",
+		       rmem_kexec_preserved_setup);
+
+/**
+ * of_reserved_mem_lookup_preserved() - find a region preserved across kexec
+ * @label:	label the previous kernel registered the region with
+ *
+ * Returns the region, or NULL if there is none (e.g. after a cold boot),
+ * in which case the caller rebuilds its state the slow way.
+ */
+struct reserved_mem *of_reserved_mem_lookup_preserved(const char *label)
+{
+	int i;
+
+	for (i = 0; i < reserved_mem_count; i++) {
+		struct reserved_mem *rmem = &reserved_mem[i];
+
+		if (rmem->ops == &rmem_kexec_preserved_ops &&
+		    !strcmp(rmem->priv, label))
+			return rmem;
+	}
+	return NULL;
+}
+EXPORT_SYMBOL_GPL(of_reserved_mem_lookup_preserved);
+
+/**
+ * of_reserved_mem_release_preserved() - give a preserved region to the
+ *					 page allocator
+ * @rmem:	region returned by of_reserved_mem_lookup_preserved()
+ */
+void of_reserved_mem_release_preserved(struct reserved_mem *rmem)
+{
+	unsigned long pfn;
+
+	if (WARN_ON(rmem->ops != &rmem_kexec_preserved_ops))
+		return;
+
+	rmem->ops = NULL;
+	for (pfn = PFN_DOWN(rmem->base);
+	     pfn < PFN_DOWN(rmem->base + rmem->size); pfn++)
+		free_reserved_page(pfn_to_page(pfn));
+
+	pr_info("Reserved memory: released %s, %ld KiB\n",
+		(const char *)rmem->priv, (unsigned long)rmem->size / SZ_1K);
+}
+EXPORT_SYMBOL_GPL(of_reserved_mem_release_preserved);
@@ -19,8 +19,7 @@
 #include <linux/string.h>
 #include <linux/slab.h>
 
-/* illegal phandle value (set when unresolved) */
-#define OF_PHANDLE_ILLEGAL	0xdeadbeef
+#include "of_private.h"
 
 /**
  * Find a node with the give full name by recursively following any of
@@ -247,7 +247,7 @@ static void __init of_unittest_check_phandles(void)
 	struct device_node *np;
 	struct node_hash *nh;
 	struct hlist_node *tmp;
-	int i, dup_count = 0, phandle_count = 0;
+	int i, dup_count = 0, phandle_count = 0, lookup_fail = 0;
 
 	for_each_of_allnodes(np) {
 		if (!np->phandle)
@@ -273,6 +273,20 @@ static void __init of_unittest_check_phandles(void)
 	unittest(dup_count == 0, "Found %i duplicates in %i phandles\n",
 		 dup_count, phandle_count);
 
+	/* Every lookup must give the same node, cached or not */
+	hash_for_each(phandle_ht, i, nh, node) {
+		np = of_find_node_by_phandle(nh->np->phandle);
+		if (np != nh->np) {
+			pr_info("phandle %i gave %s, expected %s\n",
+				nh->np->phandle, np ? np->full_name : "NULL",
+				nh->np->full_name);
+			lookup_fail++;
+		}
+		of_node_put(np);
+	}
+	unittest(lookup_fail == 0, "%i of %i phandle lookups failed\n",
+		 lookup_fail, phandle_count);
+
 	/* Clean up */
 	hash_for_each_safe(phandle_ht, i, tmp, nh, node) {
 		hash_del(&nh->node);
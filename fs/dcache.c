@@ -39,6 +39,7 @@
 #include <linux/ratelimit.h>
 #include <linux/list_lru.h>
 #include <linux/kasan.h>
+#include <linux/workqueue.h>
 
 #include "internal.h"
 #include "mount.h"
@@ -118,6 +119,14 @@ struct dentry_stat_t dentry_stat = {
 
 static DEFINE_PER_CPU(long, nr_dentry);
 static DEFINE_PER_CPU(long, nr_dentry_unused);
+static DEFINE_PER_CPU(long, nr_dentry_negative);
+
+/*
+ * Upper bound on the number of unused negative dentries each superblock
+ * keeps on its LRU, beyond which they are pruned in the background.
+ * Zero disables the limit.
+ */
+unsigned long sysctl_negative_dentry_limit __read_mostly;
 
 #if defined(CONFIG_SYSCTL) && defined(CONFIG_PROC_FS)
 
@@ -151,11 +160,21 @@ static long get_nr_dentry_unused(void)
 	return sum < 0 ? 0 : sum;
 }
 
+static long get_nr_dentry_negative(void)
+{
+	int i;
+	long sum = 0;
+	for_each_possible_cpu(i)
+		sum += per_cpu(nr_dentry_negative, i);
+	return sum < 0 ? 0 : sum;
+}
+
 int proc_nr_dentry(struct ctl_table *table, int write, void __user *buffer,
 		   size_t *lenp, loff_t *ppos)
 {
 	dentry_stat.nr_dentry = get_nr_dentry();
 	dentry_stat.nr_unused = get_nr_dentry_unused();
+	dentry_stat.nr_negative = get_nr_dentry_negative();
 	return proc_doulongvec_minmax(table, write, buffer, lenp, ppos);
 }
 #endif
@@ -269,6 +288,28 @@ static inline int dname_external(const struct dentry *dentry)
 	return dentry->d_name.name != dentry->d_iname;
 }
 
+/*
+ * Unused negative dentries sitting on the superblock LRU are counted both
+ * globally and per superblock, so that their number can be bounded.
+ */
+static inline bool d_on_sb_lru(const struct dentry *dentry)
+{
+	return (dentry->d_flags & (DCACHE_LRU_LIST | DCACHE_SHRINK_LIST)) ==
+		DCACHE_LRU_LIST;
+}
+
+static inline void d_lru_negative_inc(struct dentry *dentry)
+{
+	this_cpu_inc(nr_dentry_negative);
+	percpu_counter_inc(&dentry->d_sb->s_nr_negative_dentries);
+}
+
+static inline void d_lru_negative_dec(struct dentry *dentry)
+{
+	this_cpu_dec(nr_dentry_negative);
+	percpu_counter_dec(&dentry->d_sb->s_nr_negative_dentries);
+}
+
 /*
  * Make sure other CPUs see the inode attached before the type is set.
  */
@@ -278,6 +319,8 @@ static inline void __d_set_inode_and_type(struct dentry *dentry,
 {
 	unsigned flags;
 
+	if (d_is_negative(dentry) && d_on_sb_lru(dentry))
+		d_lru_negative_dec(dentry);
 	dentry->d_inode = inode;
 	smp_wmb();
 	flags = READ_ONCE(dentry->d_flags);
@@ -298,6 +341,9 @@ static inline void __d_clear_type_and_inode(struct dentry *dentry)
 {
 	unsigned flags = READ_ONCE(dentry->d_flags);
 
+	if (!d_is_negative(dentry) && d_on_sb_lru(dentry))
+		d_lru_negative_inc(dentry);
+
 	flags &= ~(DCACHE_ENTRY_TYPE | DCACHE_FALLTHRU);
 	WRITE_ONCE(dentry->d_flags, flags);
 	smp_wmb();
@@ -392,17 +438,24 @@ static void dentry_unlink_inode(struct dentry * dentry)
  * on the shrink list (ie not on the superblock LRU list).
  *
  * The per-cpu "nr_dentry_unused" counters are updated with
- * the DCACHE_LRU_LIST bit.
+ * the DCACHE_LRU_LIST bit.  The negative dentry counters only
+ * cover dentries on the superblock LRU list.
  *
  * These helper functions make sure we always follow the
  * rules. d_lock must be held by the caller.
  */
 #define D_FLAG_VERIFY(dentry,x) WARN_ON_ONCE(((dentry)->d_flags & (DCACHE_LRU_LIST | DCACHE_SHRINK_LIST)) != (x))
+static void d_negative_check(struct super_block *sb);
+
 static void d_lru_add(struct dentry *dentry)
 {
 	D_FLAG_VERIFY(dentry, 0);
 	dentry->d_flags |= DCACHE_LRU_LIST;
 	this_cpu_inc(nr_dentry_unused);
+	if (d_is_negative(dentry)) {
+		d_lru_negative_inc(dentry);
+		d_negative_check(dentry->d_sb);
+	}
 	WARN_ON_ONCE(!list_lru_add(&dentry->d_sb->s_dentry_lru, &dentry->d_lru));
 }
 
@@ -411,6 +464,8 @@ static void d_lru_del(struct dentry *dentry)
 	D_FLAG_VERIFY(dentry, DCACHE_LRU_LIST);
 	dentry->d_flags &= ~DCACHE_LRU_LIST;
 	this_cpu_dec(nr_dentry_unused);
+	if (d_is_negative(dentry))
+		d_lru_negative_dec(dentry);
 	WARN_ON_ONCE(!list_lru_del(&dentry->d_sb->s_dentry_lru, &dentry->d_lru));
 }
 
@@ -441,6 +496,8 @@ static void d_lru_isolate(struct list_lru_one *lru, struct dentry *dentry)
 	D_FLAG_VERIFY(dentry, DCACHE_LRU_LIST);
 	dentry->d_flags &= ~DCACHE_LRU_LIST;
 	this_cpu_dec(nr_dentry_unused);
+	if (d_is_negative(dentry))
+		d_lru_negative_dec(dentry);
 	list_lru_isolate(lru, &dentry->d_lru);
 }
 
@@ -449,6 +506,8 @@ static void d_lru_shrink_move(struct list_lru_one *lru, struct dentry *dentry,
 {
 	D_FLAG_VERIFY(dentry, DCACHE_LRU_LIST);
 	dentry->d_flags |= DCACHE_SHRINK_LIST;
+	if (d_is_negative(dentry))
+		d_lru_negative_dec(dentry);
 	list_lru_isolate_move(lru, &dentry->d_lru, list);
 }
 
@@ -1141,6 +1200,110 @@ void shrink_dcache_sb(struct super_block *sb)
 }
 EXPORT_SYMBOL(shrink_dcache_sb);
 
+#define NEGATIVE_PRUNE_BATCH	1024UL
+
+struct negative_dentry_prune {
+	struct list_head dispose;
+	long nr_to_free;
+};
+
+static enum lru_status dentry_negative_lru_isolate(struct list_head *item,
+		struct list_lru_one *lru, spinlock_t *lru_lock, void *arg)
+{
+	struct negative_dentry_prune *prune = arg;
+	struct dentry	*dentry = container_of(item, struct dentry, d_lru);
+
+	if (prune->nr_to_free <= 0)
+		return LRU_SKIP;
+
+	if (!spin_trylock(&dentry->d_lock))
+		return LRU_SKIP;
+
+	if (dentry->d_lockref.count) {
+		d_lru_isolate(lru, dentry);
+		spin_unlock(&dentry->d_lock);
+		return LRU_REMOVED;
+	}
+
+	/*
+	 * Positive dentries are left to the shrinker.  They are rotated
+	 * rather than skipped so that the next batch doesn't walk them
+	 * again, at the cost of aging them a little more slowly.
+	 */
+	if (!d_is_negative(dentry)) {
+		spin_unlock(&dentry->d_lock);
+		return LRU_ROTATE;
+	}
+
+	if (dentry->d_flags & DCACHE_REFERENCED) {
+		dentry->d_flags &= ~DCACHE_REFERENCED;
+		spin_unlock(&dentry->d_lock);
+		return LRU_ROTATE;
+	}
+
+	d_lru_shrink_move(lru, dentry, &prune->dispose);
+	spin_unlock(&dentry->d_lock);
+	prune->nr_to_free--;
+
+	return LRU_REMOVED;
+}
+
+static void prune_negative_dentries_sb(struct super_block *sb, void *unused)
+{
+	unsigned long limit = READ_ONCE(sysctl_negative_dentry_limit);
+	struct negative_dentry_prune prune;
+	unsigned long to_walk;
+	s64 nr;
+
+	if (!limit)
+		return;
+	nr = percpu_counter_sum_positive(&sb->s_nr_negative_dentries);
+	if (nr <= limit)
+		return;
+
+	/* Leave some slack so that we don't come straight back here */
+	INIT_LIST_HEAD(&prune.dispose);
+	prune.nr_to_free = nr - limit + limit / 8;
+
+	/* Walk in batches so as not to hold the LRU lock for too long */
+	to_walk = list_lru_count(&sb->s_dentry_lru);
+	while (to_walk && prune.nr_to_free > 0) {
+		unsigned long batch = min(to_walk, NEGATIVE_PRUNE_BATCH);
+
+		list_lru_walk(&sb->s_dentry_lru, dentry_negative_lru_isolate,
+			      &prune, batch);
+		to_walk -= batch;
+		shrink_dentry_list(&prune.dispose);
+		cond_resched();
+	}
+}
+
+static unsigned long negative_dentry_prune_pending;
+
+static void prune_negative_dentries(struct work_struct *work)
+{
+	iterate_supers(prune_negative_dentries_sb, NULL);
+	clear_bit(0, &negative_dentry_prune_pending);
+}
+
+static DECLARE_WORK(negative_dentry_prune_work, prune_negative_dentries);
+
+/*
+ * Called with d_lock held whenever a negative dentry goes onto the LRU;
+ * kicks off background pruning once @sb holds more than the limit.
+ */
+static void d_negative_check(struct super_block *sb)
+{
+	unsigned long limit = READ_ONCE(sysctl_negative_dentry_limit);
+
+	if (!limit)
+		return;
+	if (percpu_counter_read_positive(&sb->s_nr_negative_dentries) <= limit)
+		return;
+	if (!test_and_set_bit(0, &negative_dentry_prune_pending))
+		schedule_work(&negative_dentry_prune_work);
+}
+
 /**
  * enum d_walk_ret - action to talke during tree walk
  * @D_WALK_CONTINUE:	contrinue walk
@@ -3416,6 +3579,10 @@ static void __init dcache_init(void)
 	dentry_cache = KMEM_CACHE(dentry,
 		SLAB_RECLAIM_ACCOUNT|SLAB_PANIC|SLAB_MEM_SPREAD);
 
+	/* By default let negative dentries use up to 1/64th of memory */
+	sysctl_negative_dentry_limit = totalram_pages / 64 *
+		(PAGE_SIZE / sizeof(struct dentry));
+
 	/* Hash may have been set up in dcache_init_early */
 	if (!hashdist)
 		return;
@@ -124,6 +124,7 @@ struct dio {
 	unsigned long refcount;		/* direct_io_worker() and bios */
 	struct bio *bio_list;		/* singly linked via bi_private */
 	struct task_struct *waiter;	/* waiting task (NULL if none) */
+	struct block_device *bio_bdev;	/* bdev of the last submitted bio */
 
 	/* AIO related stuff */
 	struct kiocb *iocb;		/* kiocb */
@@ -396,6 +397,8 @@ static inline void dio_bio_submit(struct dio *dio, struct dio_submit *sdio)
 	if (dio->is_async && dio->rw == READ)
 		bio_set_pages_dirty(bio);
 
+	dio->bio_bdev = bio->bi_bdev;
+
 	if (sdio->submit_io)
 		sdio->submit_io(dio->rw, bio, dio->inode,
 			       sdio->logical_offset_in_bio);
@@ -426,6 +429,7 @@ static struct bio *dio_await_one(struct dio *dio)
 {
 	unsigned long flags;
 	struct bio *bio = NULL;
+	bool polled = false;
 
 	spin_lock_irqsave(&dio->bio_lock, flags);
 
@@ -434,12 +438,18 @@ static struct bio *dio_await_one(struct dio *dio)
 	 * completion drops the count, maybe adds to the list, and wakes while
 	 * holding the bio_lock so we don't need set_current_state()'s barrier
 	 * and can call it after testing our condition.
+	 *
+	 * Synchronous I/O to a queue with polling enabled spins on the
+	 * hardware queue for the completion instead of sleeping for it.
 	 */
 	while (dio->refcount > 1 && dio->bio_list == NULL) {
 		__set_current_state(TASK_UNINTERRUPTIBLE);
 		dio->waiter = current;
 		spin_unlock_irqrestore(&dio->bio_lock, flags);
-		io_schedule();
+		if (!dio->bio_bdev ||
+		    !blk_poll(bdev_get_queue(dio->bio_bdev), dio->rw, !polled))
+			io_schedule();
+		polled = true;
 		/* wake up sets us TASK_RUNNING */
 		spin_lock_irqsave(&dio->bio_lock, flags);
 		dio->waiter = NULL;
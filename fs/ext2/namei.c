@@ -191,6 +191,7 @@ static int ext2_symlink (struct inode * dir, struct dentry * dentry,
 		inode->i_op = &ext2_fast_symlink_inode_operations;
 		memcpy((char*)(EXT2_I(inode)->i_data),symname,l);
 		inode->i_size = l-1;
+		inode->i_link = (char *)EXT2_I(inode)->i_data;
 	}
 	mark_inode_dirty(inode);
 
@@ -3255,6 +3255,8 @@ static int ext4_symlink(struct inode *dir,
 		memcpy((char *)&EXT4_I(inode)->i_data, disk_link.name,
 		       disk_link.len);
 		inode->i_size = disk_link.len - 1;
+		if (!encryption_required)
+			inode->i_link = (char *)&EXT4_I(inode)->i_data;
 	}
 	EXT4_I(inode)->i_disksize = inode->i_size;
 	err = ext4_add_nondir(handle, dentry, inode);
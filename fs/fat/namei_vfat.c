@@ -41,20 +41,16 @@ static int vfat_revalidate_shortname(struct dentry *dentry)
 
 static int vfat_revalidate(struct dentry *dentry, unsigned int flags)
 {
-	if (flags & LOOKUP_RCU)
-		return -ECHILD;
-
 	/* This is not negative dentry. Always valid. */
 	if (d_really_is_positive(dentry))
 		return 1;
+	if (flags & LOOKUP_RCU)
+		return -ECHILD;
 	return vfat_revalidate_shortname(dentry);
 }
 
 static int vfat_revalidate_ci(struct dentry *dentry, unsigned int flags)
 {
-	if (flags & LOOKUP_RCU)
-		return -ECHILD;
-
 	/*
 	 * This is not negative dentry. Always valid.
 	 *
@@ -67,6 +63,8 @@ static int vfat_revalidate_ci(struct dentry *dentry, unsigned int flags)
 	 */
 	if (d_really_is_positive(dentry))
 		return 1;
+	if (flags & LOOKUP_RCU)
+		return -ECHILD;
 
 	/*
 	 * This may be nfsd (or something), anyway, we can't see the
@@ -907,6 +907,18 @@ start_journal_io:
 	if (err)
 		jbd2_journal_abort(journal, err);
 
+	/*
+	 * The transaction is now safe on disk.  Let fsync() callers in
+	 * jbd2_complete_transaction() go without waiting for the rest of
+	 * the commit processing below.
+	 */
+	if (!is_journal_aborted(journal)) {
+		write_lock(&journal->j_state_lock);
+		journal->j_durable_sequence = commit_transaction->t_tid;
+		write_unlock(&journal->j_state_lock);
+		wake_up(&journal->j_wait_done_commit);
+	}
+
 	/*
 	 * Now disk caches for filesystem device are flushed so we are safe to
 	 * erase checkpointed transactions from the log by updating journal
@@ -1160,5 +1172,6 @@ restart_loop:
 	journal->j_stats.run.rs_handle_count += stats.run.rs_handle_count;
 	journal->j_stats.run.rs_blocks += stats.run.rs_blocks;
 	journal->j_stats.run.rs_blocks_logged += stats.run.rs_blocks_logged;
+	journal->j_commit_hist.buckets[jbd2_hist_bucket(commit_time)]++;
 	spin_unlock(&journal->j_history_lock);
 }
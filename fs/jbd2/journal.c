@@ -724,13 +724,41 @@ int jbd2_log_wait_commit(journal_t *journal, tid_t tid)
 }
 
 /*
- * When this function returns the transaction corresponding to tid
- * will be completed.  If the transaction has currently running, start
- * committing that transaction before waiting for it to complete.  If
- * the transaction id is stale, it is by definition already completed,
- * so just return SUCCESS.
+ * Like jbd2_log_wait_commit(), but only wait for the commit record of
+ * transaction @tid to reach the disk, not for the commit to be finished.
  */
-int jbd2_complete_transaction(journal_t *journal, tid_t tid)
+static int jbd2_log_wait_durable(journal_t *journal, tid_t tid)
+{
+	ktime_t start = ktime_get();
+	int err = 0;
+
+	read_lock(&journal->j_state_lock);
+	while (tid_gt(tid, journal->j_durable_sequence) &&
+	       tid_gt(tid, journal->j_commit_sequence)) {
+		read_unlock(&journal->j_state_lock);
+		wake_up(&journal->j_wait_commit);
+		wait_event(journal->j_wait_done_commit,
+			   !tid_gt(tid, journal->j_durable_sequence) ||
+			   !tid_gt(tid, journal->j_commit_sequence));
+		read_lock(&journal->j_state_lock);
+	}
+	read_unlock(&journal->j_state_lock);
+
+	spin_lock(&journal->j_history_lock);
+	journal->j_fsync_hist.buckets[jbd2_hist_bucket(
+		ktime_to_ns(ktime_sub(ktime_get(), start)))]++;
+	spin_unlock(&journal->j_history_lock);
+
+	if (unlikely(is_journal_aborted(journal)))
+		err = -EIO;
+	return err;
+}
+
+/*
+ * Start committing transaction @tid if it is still running.  Returns 0
+ * if there is nothing to wait for, because @tid is stale.
+ */
+static int jbd2_start_commit_tid(journal_t *journal, tid_t tid)
 {
 	int	need_to_wait = 1;
 
@@ -741,19 +769,45 @@ int jbd2_complete_transaction(journal_t *journal, tid_t tid)
 			/* transaction not yet started, so request it */
 			read_unlock(&journal->j_state_lock);
 			jbd2_log_start_commit(journal, tid);
-			goto wait_commit;
+			return 1;
 		}
 	} else if (!(journal->j_committing_transaction &&
 		     journal->j_committing_transaction->t_tid == tid))
 		need_to_wait = 0;
 	read_unlock(&journal->j_state_lock);
-	if (!need_to_wait)
+	return need_to_wait;
+}
+
+/*
+ * When this function returns the transaction corresponding to tid
+ * will be completed.  If the transaction has currently running, start
+ * committing that transaction before waiting for it to complete.  If
+ * the transaction id is stale, it is by definition already completed,
+ * so just return SUCCESS.
+ */
+int jbd2_complete_transaction(journal_t *journal, tid_t tid)
+{
+	if (!jbd2_start_commit_tid(journal, tid))
 		return 0;
-wait_commit:
 	return jbd2_log_wait_commit(journal, tid);
 }
 EXPORT_SYMBOL(jbd2_complete_transaction);
 
+/*
+ * Like jbd2_complete_transaction(), but return as soon as the commit
+ * record of transaction @tid is on disk, without waiting for the rest
+ * of the commit (e.g. releasing the transaction's buffers) to finish.
+ * That is all fsync() needs.  The time spent waiting is recorded in
+ * the fsync histogram.
+ */
+int jbd2_complete_transaction_durable(journal_t *journal, tid_t tid)
+{
+	if (!jbd2_start_commit_tid(journal, tid))
+		return 0;
+	return jbd2_log_wait_durable(journal, tid);
+}
+EXPORT_SYMBOL(jbd2_complete_transaction_durable);
+
 /*
  * Log buffer allocation routines:
  */
@@ -1042,6 +1096,60 @@ static const struct file_operations jbd2_seq_info_fops = {
 	.release        = jbd2_seq_info_release,
 };
 
+static int jbd2_seq_latency_show(struct seq_file *seq, void *v)
+{
+	journal_t *journal = seq->private;
+	struct jbd2_latency_hist commit, fsync;
+	int i;
+
+	spin_lock(&journal->j_history_lock);
+	commit = journal->j_commit_hist;
+	fsync = journal->j_fsync_hist;
+	spin_unlock(&journal->j_history_lock);
+
+	seq_printf(seq, "%-21s %12s %12s\n", "usecs", "commit", "fsync");
+	for (i = 0; i < JBD2_HIST_BUCKETS; i++) {
+		unsigned long lo = i ? 1UL << (i - 1) : 0;
+
+		if (i == JBD2_HIST_BUCKETS - 1)
+			seq_printf(seq, "%10lu -        inf", lo);
+		else
+			seq_printf(seq, "%10lu - %10lu", lo, 1UL << i);
+		seq_printf(seq, " %12lu %12lu\n",
+			   commit.buckets[i], fsync.buckets[i]);
+	}
+	return 0;
+}
+
+static int jbd2_seq_latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, jbd2_seq_latency_show, PDE_DATA(inode));
+}
+
+/* Any write clears the histograms */
+static ssize_t jbd2_seq_latency_write(struct file *file,
+				      const char __user *buf,
+				      size_t count, loff_t *ppos)
+{
+	struct seq_file *seq = file->private_data;
+	journal_t *journal = seq->private;
+
+	spin_lock(&journal->j_history_lock);
+	memset(&journal->j_commit_hist, 0, sizeof(journal->j_commit_hist));
+	memset(&journal->j_fsync_hist, 0, sizeof(journal->j_fsync_hist));
+	spin_unlock(&journal->j_history_lock);
+	return count;
+}
+
+static const struct file_operations jbd2_seq_latency_fops = {
+	.owner		= THIS_MODULE,
+	.open		= jbd2_seq_latency_open,
+	.read		= seq_read,
+	.write		= jbd2_seq_latency_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 static struct proc_dir_entry *proc_jbd2_stats;
 
 static void jbd2_stats_proc_init(journal_t *journal)
@@ -1050,11 +1158,15 @@ static void jbd2_stats_proc_init(journal_t *journal)
 	if (journal->j_proc_entry) {
 		proc_create_data("info", S_IRUGO, journal->j_proc_entry,
 				 &jbd2_seq_info_fops, journal);
+		proc_create_data("latency", S_IRUGO | S_IWUSR,
+				 journal->j_proc_entry,
+				 &jbd2_seq_latency_fops, journal);
 	}
 }
 
 static void jbd2_stats_proc_exit(journal_t *journal)
 {
+	remove_proc_entry("latency", journal->j_proc_entry);
 	remove_proc_entry("info", journal->j_proc_entry);
 	remove_proc_entry(journal->j_devname, proc_jbd2_stats);
 }
@@ -1297,6 +1409,7 @@ static int journal_reset(journal_t *journal)
 
 	journal->j_tail_sequence = journal->j_transaction_sequence;
 	journal->j_commit_sequence = journal->j_transaction_sequence - 1;
+	journal->j_durable_sequence = journal->j_commit_sequence;
 	journal->j_commit_request = journal->j_commit_sequence;
 
 	journal->j_max_transaction_buffers = journal->j_maxlen / 4;
@@ -499,6 +499,7 @@ struct nameidata {
 	struct inode	*inode; /* path.dentry.d_inode */
 	unsigned int	flags;
 	unsigned	seq, m_seq;
+	unsigned	link_seq;	/* seq of a symlink followed in rcu-walk */
 	int		last_type;
 	unsigned	depth;
 	struct file	*base;
@@ -752,26 +753,30 @@ int sysctl_protected_hardlinks __read_mostly = 0;
  *
  * Returns 0 if following the symlink is allowed, -ve on error.
  */
-static inline int may_follow_link(struct path *link, struct nameidata *nd)
+static inline bool link_unsafe(const struct inode *inode,
+			       const struct inode *parent)
 {
-	const struct inode *inode;
-	const struct inode *parent;
-
 	if (!sysctl_protected_symlinks)
-		return 0;
+		return false;
 
 	/* Allowed if owner and follower match. */
-	inode = link->dentry->d_inode;
 	if (uid_eq(current_cred()->fsuid, inode->i_uid))
-		return 0;
+		return false;
 
 	/* Allowed if parent directory not sticky and world-writable. */
-	parent = nd->path.dentry->d_inode;
 	if ((parent->i_mode & (S_ISVTX|S_IWOTH)) != (S_ISVTX|S_IWOTH))
-		return 0;
+		return false;
 
 	/* Allowed if parent directory and link owner match. */
 	if (uid_eq(parent->i_uid, inode->i_uid))
+		return false;
+
+	return true;
+}
+
+static inline int may_follow_link(struct path *link, struct nameidata *nd)
+{
+	if (!link_unsafe(link->dentry->d_inode, nd->path.dentry->d_inode))
 		return 0;
 
 	audit_log_link_denied("follow_link", link);
@@ -871,7 +876,7 @@ follow_link(struct path *link, struct nameidata *nd, void **p)
 	touch_atime(link);
 	nd_set_link(nd, NULL);
 
-	error = security_inode_follow_link(link->dentry, nd);
+	error = security_inode_follow_link(dentry, dentry->d_inode, false);
 	if (error)
 		goto out_put_nd_path;
 
@@ -1569,10 +1574,19 @@ static inline int should_follow_link(struct dentry *dentry, int follow)
 	return unlikely(d_is_symlink(dentry)) ? follow : 0;
 }
 
+/*
+ * Passed to walk_component() along with LOOKUP_FOLLOW by callers that can
+ * follow a symlink in rcu-walk mode: if the link body is available without
+ * blocking, walk_component() returns 1 without dropping out of rcu-walk,
+ * leaving nd->seq at the parent and the link's seq in nd->link_seq.
+ */
+#define WALK_RCU_LINK	0x10000
+
 static inline int walk_component(struct nameidata *nd, struct path *path,
 		int follow)
 {
 	struct inode *inode;
+	unsigned seq = nd->seq;
 	int err;
 	/*
 	 * "." and ".." are special - ".." especially so because it has
@@ -1598,6 +1612,13 @@ static inline int walk_component(struct nameidata *nd, struct path *path,
 
 	if (should_follow_link(path->dentry, follow)) {
 		if (nd->flags & LOOKUP_RCU) {
+			if ((follow & WALK_RCU_LINK) &&
+			    nd->path.mnt == path->mnt &&
+			    READ_ONCE(inode->i_link)) {
+				nd->link_seq = nd->seq;
+				nd->seq = seq;
+				return 1;
+			}
 			if (unlikely(nd->path.mnt != path->mnt ||
 				     unlazy_walk(nd, path->dentry))) {
 				err = -ECHILD;
@@ -1618,6 +1639,77 @@ out_err:
 	return err;
 }
 
+/*
+ * Follow a symlink left by walk_component() without leaving rcu-walk.
+ * Only links whose body hangs off the inode (->i_link) qualify; the body
+ * must stay put until the inode is freed through RCU.
+ *
+ * Returns 0 with the body walked up to its last component, a negative
+ * error after terminating the walk, or 1 if the link has to be followed
+ * in ref-walk mode (see unlazy_link()).
+ */
+static int follow_link_rcu(struct path *link, struct nameidata *nd)
+{
+	struct dentry *dentry = link->dentry;
+	struct inode *inode = READ_ONCE(dentry->d_inode);
+	const char *s;
+	int error;
+
+	if (unlikely(!inode))
+		return 1;
+	s = READ_ONCE(inode->i_link);
+	if (unlikely(!s))
+		return 1;
+	if (read_seqcount_retry(&dentry->d_seq, nd->link_seq))
+		return 1;
+
+	if (unlikely(current->total_link_count >= 40)) {
+		terminate_walk(nd);
+		return -ELOOP;
+	}
+
+	/* Leave the slow cases to follow_link() */
+	if (link_unsafe(inode, nd->inode))
+		return 1;
+	if (atime_needs_update(link, inode))
+		return 1;
+
+	error = security_inode_follow_link(dentry, inode, true);
+	if (unlikely(error)) {
+		if (error == -ECHILD)
+			return 1;
+		terminate_walk(nd);
+		return error;
+	}
+
+	current->total_link_count++;
+	nd->last_type = LAST_BIND;
+	if (*s == '/') {
+		if (!nd->root.mnt)
+			set_root_rcu(nd);
+		nd->path = nd->root;
+		nd->seq = read_seqcount_begin(&nd->path.dentry->d_seq);
+		nd->inode = nd->path.dentry->d_inode;
+		nd->flags |= LOOKUP_JUMPED;
+	}
+	return link_path_walk(s, nd);
+}
+
+/*
+ * Drop out of rcu-walk at a symlink left by walk_component(), so that
+ * follow_link() can be used on it.  Terminates the walk on failure.
+ */
+static int unlazy_link(struct path *link, struct nameidata *nd)
+{
+	nd->seq = nd->link_seq;
+	if (unlikely(nd->path.mnt != link->mnt ||
+		     unlazy_walk(nd, link->dentry))) {
+		terminate_walk(nd);
+		return -ECHILD;
+	}
+	return 0;
+}
+
 /*
  * This limits recursive symlink follows to 8, while
  * limiting consecutive symlinks to 40.
@@ -1630,8 +1722,12 @@ static inline int nested_symlink(struct path *path, struct nameidata *nd)
 	int res;
 
 	if (unlikely(current->link_count >= MAX_NESTED_LINKS)) {
-		path_put_conditional(path, nd);
-		path_put(&nd->path);
+		if (nd->flags & LOOKUP_RCU) {
+			terminate_walk(nd);
+		} else {
+			path_put_conditional(path, nd);
+			path_put(&nd->path);
+		}
 		return -ELOOP;
 	}
 	BUG_ON(nd->depth >= MAX_NESTED_LINKS);
@@ -1643,10 +1739,23 @@ static inline int nested_symlink(struct path *path, struct nameidata *nd)
 		struct path link = *path;
 		void *cookie;
 
+		if (nd->flags & LOOKUP_RCU) {
+			res = follow_link_rcu(&link, nd);
+			if (res <= 0) {
+				if (!res)
+					res = walk_component(nd, path,
+						LOOKUP_FOLLOW | WALK_RCU_LINK);
+				continue;
+			}
+			res = unlazy_link(&link, nd);
+			if (res)
+				break;
+		}
+
 		res = follow_link(&link, nd, &cookie);
 		if (res)
 			break;
-		res = walk_component(nd, path, LOOKUP_FOLLOW);
+		res = walk_component(nd, path, LOOKUP_FOLLOW | WALK_RCU_LINK);
 		put_link(nd, &link, cookie);
 	} while (res > 0);
 
@@ -1841,7 +1950,7 @@ static int link_path_walk(const char *name, struct nameidata *nd)
 		if (!*name)
 			return 0;
 
-		err = walk_component(nd, &next, LOOKUP_FOLLOW);
+		err = walk_component(nd, &next, LOOKUP_FOLLOW | WALK_RCU_LINK);
 		if (err < 0)
 			return err;
 
@@ -1977,7 +2086,9 @@ static inline int lookup_last(struct nameidata *nd, struct path *path)
 		nd->flags |= LOOKUP_FOLLOW | LOOKUP_DIRECTORY;
 
 	nd->flags &= ~LOOKUP_PARENT;
-	return walk_component(nd, path, nd->flags & LOOKUP_FOLLOW);
+	if (!(nd->flags & LOOKUP_FOLLOW))
+		return walk_component(nd, path, 0);
+	return walk_component(nd, path, LOOKUP_FOLLOW | WALK_RCU_LINK);
 }
 
 /* Returns 0 and nd will be valid on success; Retuns error, otherwise. */
@@ -2007,6 +2118,19 @@ static int path_lookupat(int dfd, const struct filename *name,
 		while (err > 0) {
 			void *cookie;
 			struct path link = path;
+
+			if (nd->flags & LOOKUP_RCU) {
+				nd->flags |= LOOKUP_PARENT;
+				err = follow_link_rcu(&link, nd);
+				if (err <= 0) {
+					if (!err)
+						err = lookup_last(nd, &path);
+					continue;
+				}
+				err = unlazy_link(&link, nd);
+				if (err)
+					break;
+			}
 			err = may_follow_link(&link, nd);
 			if (unlikely(err))
 				break;
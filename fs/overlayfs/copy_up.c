@@ -91,6 +91,12 @@ static int ovl_copy_up_data(struct path *old, struct path *new, loff_t len)
 		goto out_fput;
 	}
 
+	/* Share the data blocks if both layers are on the same filesystem */
+	error = vfs_clone_file_range(old_file, 0, new_file, 0, len);
+	if (!error)
+		goto out;
+	error = 0;
+
 	/* FIXME: copy up sparse files efficiently */
 	while (len) {
 		size_t this_len = OVL_COPY_UP_CHUNK_SIZE;
@@ -115,7 +121,7 @@ static int ovl_copy_up_data(struct path *old, struct path *new, loff_t len)
 
 		len -= bytes;
 	}
-
+out:
 	fput(new_file);
 out_fput:
 	fput(old_file);
@@ -193,10 +199,62 @@ int ovl_set_attr(struct dentry *upperdentry, struct kstat *stat)
 	return err;
 }
 
+/*
+ * Only give the upper file the size of the lower one; the data stays on
+ * the lower layer until ovl_copy_up_meta_data().
+ */
+static int ovl_set_metacopy(struct dentry *newdentry, struct kstat *stat)
+{
+	struct iattr attr = {
+		.ia_valid = ATTR_SIZE,
+		.ia_size = stat->size,
+	};
+	int err;
+
+	err = ovl_do_setxattr(newdentry, OVL_XATTR_METACOPY, "y", 1, 0);
+	if (err)
+		return err;
+
+	mutex_lock(&newdentry->d_inode->i_mutex);
+	err = notify_change(newdentry, &attr, NULL);
+	mutex_unlock(&newdentry->d_inode->i_mutex);
+
+	return err;
+}
+
+static int ovl_copy_up_meta_data(struct dentry *dentry, struct path *lowerpath,
+				 struct kstat *stat)
+{
+	struct path upperpath;
+	struct kstat ustat;
+	int err;
+
+	ovl_path_upper(dentry, &upperpath);
+	err = vfs_getattr(&upperpath, &ustat);
+	if (err)
+		return err;
+
+	err = ovl_copy_up_data(lowerpath, &upperpath, stat->size);
+	if (err)
+		return err;
+
+	err = ovl_do_removexattr(upperpath.dentry, OVL_XATTR_METACOPY);
+	if (err)
+		return err;
+
+	/* Filling in the data doesn't count as a modification */
+	mutex_lock(&upperpath.dentry->d_inode->i_mutex);
+	ovl_set_timestamps(upperpath.dentry, &ustat);
+	mutex_unlock(&upperpath.dentry->d_inode->i_mutex);
+
+	ovl_dentry_set_metacopy(dentry, false);
+	return 0;
+}
+
 static int ovl_copy_up_locked(struct dentry *workdir, struct dentry *upperdir,
 			      struct dentry *dentry, struct path *lowerpath,
 			      struct kstat *stat, struct iattr *attr,
-			      const char *link)
+			      const char *link, bool metacopy)
 {
 	struct inode *wdir = workdir->d_inode;
 	struct inode *udir = upperdir->d_inode;
@@ -223,7 +281,19 @@ static int ovl_copy_up_locked(struct dentry *workdir, struct dentry *upperdir,
 	if (err)
 		goto out2;
 
-	if (S_ISREG(stat->mode)) {
+	if (!S_ISREG(stat->mode) || !stat->size)
+		metacopy = false;
+
+	if (metacopy) {
+		err = ovl_set_metacopy(newdentry, stat);
+		/* Fall back to copying the data if upper can't mark the file */
+		if (err == -EOPNOTSUPP)
+			metacopy = false;
+		else if (err)
+			goto out_cleanup;
+	}
+
+	if (S_ISREG(stat->mode) && !metacopy) {
 		struct path upperpath;
 		ovl_path_upper(dentry, &upperpath);
 		BUG_ON(upperpath.dentry != NULL);
@@ -250,6 +320,9 @@ static int ovl_copy_up_locked(struct dentry *workdir, struct dentry *upperdir,
 	if (err)
 		goto out_cleanup;
 
+	/* Must be visible no later than the upper dentry */
+	if (metacopy)
+		ovl_dentry_set_metacopy(dentry, true);
 	ovl_dentry_update(dentry, newdentry);
 	newdentry = NULL;
 
@@ -284,10 +357,14 @@ out_cleanup:
  * up uses upper parent i_mutex for exclusion.  Since rename can change
  * d_parent it is possible that the copy up will lock the old parent.  At
  * that point the file will have already been copied up anyway.
+ *
+ * With @metacopy a regular file only gets its metadata copied up.  Without
+ * it, a file that was copied up that way gets its data filled in, under the
+ * same exclusion.
  */
 int ovl_copy_up_one(struct dentry *parent, struct dentry *dentry,
 		    struct path *lowerpath, struct kstat *stat,
-		    struct iattr *attr)
+		    struct iattr *attr, bool metacopy)
 {
 	struct dentry *workdir = ovl_workdir(dentry);
 	int err;
@@ -345,10 +422,12 @@ int ovl_copy_up_one(struct dentry *parent, struct dentry *dentry,
 	}
 	upperdentry = ovl_dentry_upper(dentry);
 	if (upperdentry) {
-		unlock_rename(workdir, upperdir);
 		err = 0;
+		if (!metacopy && ovl_dentry_is_metacopy(dentry))
+			err = ovl_copy_up_meta_data(dentry, lowerpath, stat);
+		unlock_rename(workdir, upperdir);
 		/* Raced with another copy-up?  Do the setattr here */
-		if (attr) {
+		if (!err && attr) {
 			mutex_lock(&upperdentry->d_inode->i_mutex);
 			err = notify_change(upperdentry, attr, NULL);
 			mutex_unlock(&upperdentry->d_inode->i_mutex);
@@ -357,7 +436,7 @@ int ovl_copy_up_one(struct dentry *parent, struct dentry *dentry,
 	}
 
 	err = ovl_copy_up_locked(workdir, upperdir, dentry, lowerpath,
-				 stat, attr, link);
+				 stat, attr, link, metacopy);
 	if (!err) {
 		/* Restore timestamps on parent (best effort) */
 		ovl_set_timestamps(upperdir, &pstat);
@@ -387,7 +466,7 @@ int ovl_copy_up(struct dentry *dentry)
 		struct kstat stat;
 		enum ovl_path_type type = ovl_path_type(dentry);
 
-		if (OVL_TYPE_UPPER(type))
+		if (OVL_TYPE_UPPER(type) && !ovl_dentry_is_metacopy(dentry))
 			break;
 
 		next = dget(dentry);
@@ -406,7 +485,8 @@ int ovl_copy_up(struct dentry *dentry)
 		ovl_path_lower(next, &lowerpath);
 		err = vfs_getattr(&lowerpath, &stat);
 		if (!err)
-			err = ovl_copy_up_one(parent, next, &lowerpath, &stat, NULL);
+			err = ovl_copy_up_one(parent, next, &lowerpath, &stat,
+					      NULL, false);
 
 		dput(parent);
 		dput(next);
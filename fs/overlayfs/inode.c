@@ -19,6 +19,7 @@ static int ovl_copy_up_last(struct dentry *dentry, struct iattr *attr,
 	struct dentry *parent;
 	struct kstat stat;
 	struct path lowerpath;
+	bool metacopy;
 
 	parent = dget_parent(dentry);
 	err = ovl_copy_up(parent);
@@ -33,7 +34,12 @@ static int ovl_copy_up_last(struct dentry *dentry, struct iattr *attr,
 	if (no_data)
 		stat.size = 0;
 
-	err = ovl_copy_up_one(parent, dentry, &lowerpath, &stat, attr);
+	/* Attribute changes other than truncate can leave the data behind */
+	metacopy = !no_data && attr && !(attr->ia_valid & ATTR_SIZE) &&
+		   ovl_metacopy_enabled(dentry);
+
+	err = ovl_copy_up_one(parent, dentry, &lowerpath, &stat, attr,
+			      metacopy);
 
 out_dput_parent:
 	dput(parent);
@@ -50,7 +56,8 @@ int ovl_setattr(struct dentry *dentry, struct iattr *attr)
 		goto out;
 
 	upperdentry = ovl_dentry_upper(dentry);
-	if (upperdentry) {
+	if (upperdentry && !(ovl_dentry_is_metacopy(dentry) &&
+			     (attr->ia_valid & ATTR_SIZE))) {
 		mutex_lock(&upperdentry->d_inode->i_mutex);
 		err = notify_change(upperdentry, attr, NULL);
 		mutex_unlock(&upperdentry->d_inode->i_mutex);
@@ -66,9 +73,21 @@ static int ovl_getattr(struct vfsmount *mnt, struct dentry *dentry,
 			 struct kstat *stat)
 {
 	struct path realpath;
+	struct path lowerpath;
+	struct kstat lowerstat;
+	int err;
 
 	ovl_path_real(dentry, &realpath);
-	return vfs_getattr(&realpath, stat);
+	err = vfs_getattr(&realpath, stat);
+	if (err || !ovl_dentry_is_metacopy(dentry))
+		return err;
+
+	/* The data, and so the blocks, are still on the lower layer */
+	ovl_path_lower(dentry, &lowerpath);
+	err = vfs_getattr(&lowerpath, &lowerstat);
+	if (!err)
+		stat->blocks = lowerstat.blocks;
+	return err;
 }
 
 int ovl_permission(struct inode *inode, int mask)
@@ -239,7 +258,8 @@ static bool ovl_need_xattr_filter(struct dentry *dentry,
 				  enum ovl_path_type type)
 {
 	if ((type & (__OVL_PATH_PURE | __OVL_PATH_UPPER)) == __OVL_PATH_UPPER)
-		return S_ISDIR(dentry->d_inode->i_mode);
+		return S_ISDIR(dentry->d_inode->i_mode) ||
+		       ovl_dentry_is_metacopy(dentry);
 	else
 		return false;
 }
@@ -321,10 +341,11 @@ out:
 	return err;
 }
 
-static bool ovl_open_need_copy_up(int flags, enum ovl_path_type type,
+static bool ovl_open_need_copy_up(struct dentry *dentry, int flags,
+				  enum ovl_path_type type,
 				  struct dentry *realdentry)
 {
-	if (OVL_TYPE_UPPER(type))
+	if (OVL_TYPE_UPPER(type) && !ovl_dentry_is_metacopy(dentry))
 		return false;
 
 	if (special_file(realdentry->d_inode->i_mode))
@@ -345,7 +366,8 @@ static int ovl_dentry_open(struct dentry *dentry, struct file *file,
 	bool want_write = false;
 
 	type = ovl_path_real(dentry, &realpath);
-	if (ovl_open_need_copy_up(file->f_flags, type, realpath.dentry)) {
+	if (ovl_open_need_copy_up(dentry, file->f_flags, type,
+				  realpath.dentry)) {
 		want_write = true;
 		err = ovl_want_write(dentry);
 		if (err)
@@ -359,6 +381,9 @@ static int ovl_dentry_open(struct dentry *dentry, struct file *file,
 			goto out_drop_write;
 
 		ovl_path_upper(dentry, &realpath);
+	} else if (ovl_dentry_is_metacopy(dentry)) {
+		/* Read the data from where it still lives */
+		ovl_path_lower(dentry, &realpath);
 	}
 
 	err = vfs_open(&realpath, file, cred);
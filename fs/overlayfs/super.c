@@ -30,6 +30,7 @@ struct ovl_config {
 	char *lowerdir;
 	char *upperdir;
 	char *workdir;
+	bool metacopy;
 };
 
 /* private information held for overlayfs's superblock */
@@ -53,6 +54,7 @@ struct ovl_entry {
 		struct {
 			u64 version;
 			bool opaque;
+			bool metacopy;
 		};
 		struct rcu_head rcu;
 	};
@@ -205,6 +207,29 @@ void ovl_dentry_set_opaque(struct dentry *dentry, bool opaque)
 	oe->opaque = opaque;
 }
 
+/*
+ * A metadata only copy up has its attributes on the upper layer while the
+ * data is still read from the lower layer, until the file is first opened
+ * for write.
+ */
+bool ovl_dentry_is_metacopy(struct dentry *dentry)
+{
+	struct ovl_entry *oe = dentry->d_fsdata;
+	return READ_ONCE(oe->metacopy);
+}
+
+void ovl_dentry_set_metacopy(struct dentry *dentry, bool metacopy)
+{
+	struct ovl_entry *oe = dentry->d_fsdata;
+	WRITE_ONCE(oe->metacopy, metacopy);
+}
+
+bool ovl_metacopy_enabled(struct dentry *dentry)
+{
+	struct ovl_fs *ofs = dentry->d_sb->s_fs_info;
+	return ofs->config.metacopy;
+}
+
 void ovl_dentry_update(struct dentry *dentry, struct dentry *upperdentry)
 {
 	struct ovl_entry *oe = dentry->d_fsdata;
@@ -259,6 +284,22 @@ static bool ovl_is_opaquedir(struct dentry *dentry)
 	return false;
 }
 
+static bool ovl_is_metacopy(struct dentry *dentry)
+{
+	int res;
+	char val;
+	struct inode *inode = dentry->d_inode;
+
+	if (!S_ISREG(inode->i_mode) || !inode->i_op->getxattr)
+		return false;
+
+	res = inode->i_op->getxattr(dentry, OVL_XATTR_METACOPY, &val, 1);
+	if (res == 1 && val == 'y')
+		return true;
+
+	return false;
+}
+
 static void ovl_dentry_release(struct dentry *dentry)
 {
 	struct ovl_entry *oe = dentry->d_fsdata;
@@ -338,6 +379,7 @@ struct dentry *ovl_lookup(struct inode *dir, struct dentry *dentry,
 	unsigned int ctr = 0;
 	struct inode *inode = NULL;
 	bool upperopaque = false;
+	bool metacopy = false;
 	struct dentry *this, *prev = NULL;
 	unsigned int i;
 	int err;
@@ -356,6 +398,8 @@ struct dentry *ovl_lookup(struct inode *dir, struct dentry *dentry,
 				upperopaque = true;
 			} else if (poe->numlower && ovl_is_opaquedir(this)) {
 				upperopaque = true;
+			} else if (poe->numlower && ovl_is_metacopy(this)) {
+				metacopy = true;
 			}
 		}
 		upperdentry = prev = this;
@@ -397,6 +441,14 @@ struct dentry *ovl_lookup(struct inode *dir, struct dentry *dentry,
 
 		if (prev && (!S_ISDIR(prev->d_inode->i_mode) ||
 			     !S_ISDIR(this->d_inode->i_mode))) {
+			/* Data for a metadata only copy up comes from here */
+			if (metacopy && prev == upperdentry &&
+			    S_ISREG(this->d_inode->i_mode)) {
+				stack[ctr].dentry = this;
+				stack[ctr].mnt = lowerpath.mnt;
+				ctr++;
+				break;
+			}
 			/*
 			 * FIXME: check for upper-opaqueness maybe better done
 			 * in remove code.
@@ -420,6 +472,13 @@ struct dentry *ovl_lookup(struct inode *dir, struct dentry *dentry,
 			break;
 	}
 
+	if (metacopy && !ctr) {
+		pr_warn_ratelimited("overlayfs: no lower data for metacopy file %pd\n",
+				    dentry);
+		err = -EIO;
+		goto out_put;
+	}
+
 	oe = ovl_alloc_entry(ctr);
 	err = -ENOMEM;
 	if (!oe)
@@ -439,6 +498,7 @@ struct dentry *ovl_lookup(struct inode *dir, struct dentry *dentry,
 	}
 
 	oe->opaque = upperopaque;
+	oe->metacopy = metacopy;
 	oe->__upperdentry = upperdentry;
 	memcpy(oe->lowerstack, stack, sizeof(struct path) * ctr);
 	kfree(stack);
@@ -522,6 +582,8 @@ static int ovl_show_options(struct seq_file *m, struct dentry *dentry)
 		seq_printf(m, ",upperdir=%s", ufs->config.upperdir);
 		seq_printf(m, ",workdir=%s", ufs->config.workdir);
 	}
+	if (ufs->config.metacopy)
+		seq_puts(m, ",metacopy=on");
 	return 0;
 }
 
@@ -546,6 +608,8 @@ enum {
 	OPT_LOWERDIR,
 	OPT_UPPERDIR,
 	OPT_WORKDIR,
+	OPT_METACOPY_ON,
+	OPT_METACOPY_OFF,
 	OPT_ERR,
 };
 
@@ -553,6 +617,8 @@ static const match_table_t ovl_tokens = {
 	{OPT_LOWERDIR,			"lowerdir=%s"},
 	{OPT_UPPERDIR,			"upperdir=%s"},
 	{OPT_WORKDIR,			"workdir=%s"},
+	{OPT_METACOPY_ON,		"metacopy=on"},
+	{OPT_METACOPY_OFF,		"metacopy=off"},
 	{OPT_ERR,			NULL}
 };
 
@@ -613,6 +679,14 @@ static int ovl_parse_opt(char *opt, struct ovl_config *config)
 				return -ENOMEM;
 			break;
 
+		case OPT_METACOPY_ON:
+			config->metacopy = true;
+			break;
+
+		case OPT_METACOPY_OFF:
+			config->metacopy = false;
+			break;
+
 		default:
 			pr_err("overlayfs: unrecognized mount option \"%s\" or missing value\n", p);
 			return -EINVAL;
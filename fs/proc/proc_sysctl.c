@@ -771,8 +771,22 @@ static const struct inode_operations proc_sys_dir_operations = {
 
 static int proc_sys_revalidate(struct dentry *dentry, unsigned int flags)
 {
-	if (flags & LOOKUP_RCU)
-		return -ECHILD;
+	struct ctl_table_header *head;
+	struct inode *inode;
+
+	if (flags & LOOKUP_RCU) {
+		/*
+		 * The header is freed by RCU once the last inode using it
+		 * lets go, so it may be looked at here without a reference.
+		 */
+		inode = READ_ONCE(dentry->d_inode);
+		if (!inode)
+			return -ECHILD;
+		head = READ_ONCE(PROC_I(inode)->sysctl);
+		if (!head)
+			return -ECHILD;
+		return !READ_ONCE(head->unregistering);
+	}
 	return !PROC_I(d_inode(dentry))->sysctl->unregistering;
 }
 
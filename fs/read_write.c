@@ -1327,3 +1327,65 @@ COMPAT_SYSCALL_DEFINE4(sendfile64, int, out_fd, int, in_fd,
 	return do_sendfile(out_fd, in_fd, NULL, count, 0);
 }
 #endif
+
+/**
+ * vfs_clone_file_range - share data between two files
+ * @file_in:	file to take the data from, open for reading
+ * @pos_in:	offset in @file_in
+ * @file_out:	file to make refer to it, open for writing
+ * @pos_out:	offset in @file_out
+ * @len:	number of bytes, 0 meaning up to the end of @file_in
+ *
+ * Make a range of @file_out share the blocks backing a range of @file_in,
+ * without copying the data.  Both files must live on the same superblock
+ * and the filesystem must implement ->clone_file_range; -EXDEV and
+ * -EOPNOTSUPP tell the caller to fall back to copying.
+ */
+int vfs_clone_file_range(struct file *file_in, loff_t pos_in,
+			 struct file *file_out, loff_t pos_out, u64 len)
+{
+	struct inode *inode_in = file_inode(file_in);
+	struct inode *inode_out = file_inode(file_out);
+	u64 count;
+	int ret;
+
+	if (inode_in->i_sb != inode_out->i_sb)
+		return -EXDEV;
+	if (S_ISDIR(inode_in->i_mode) || S_ISDIR(inode_out->i_mode))
+		return -EISDIR;
+	if (!S_ISREG(inode_in->i_mode) || !S_ISREG(inode_out->i_mode))
+		return -EINVAL;
+	if (!(file_in->f_mode & FMODE_READ) ||
+	    !(file_out->f_mode & FMODE_WRITE) ||
+	    (file_out->f_flags & O_APPEND))
+		return -EBADF;
+	if (!file_in->f_op->clone_file_range)
+		return -EOPNOTSUPP;
+
+	if (pos_in < 0 || pos_out < 0)
+		return -EINVAL;
+
+	/* len 0 clones up to the end of file_in, check that much */
+	count = len;
+	if (!count && pos_in < i_size_read(inode_in))
+		count = i_size_read(inode_in) - pos_in;
+	count = min_t(u64, count, MAX_RW_COUNT);
+
+	ret = rw_verify_area(READ, file_in, &pos_in, count);
+	if (ret < 0)
+		return ret;
+	ret = rw_verify_area(WRITE, file_out, &pos_out, count);
+	if (ret < 0)
+		return ret;
+
+	file_start_write(file_out);
+	ret = file_in->f_op->clone_file_range(file_in, pos_in,
+					      file_out, pos_out, len);
+	file_end_write(file_out);
+	if (!ret) {
+		fsnotify_access(file_in);
+		fsnotify_modify(file_out);
+	}
+	return ret;
+}
+EXPORT_SYMBOL(vfs_clone_file_range);
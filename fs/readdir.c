@@ -18,6 +18,9 @@
 #include <linux/security.h>
 #include <linux/syscalls.h>
 #include <linux/unistd.h>
+#include <linux/slab.h>
+#include <linux/namei.h>
+#include <linux/dirent_stat.h>
 
 #include <asm/uaccess.h>
 
@@ -307,3 +310,184 @@ SYSCALL_DEFINE3(getdents64, unsigned int, fd,
 	fdput(f);
 	return error;
 }
+
+/*
+ * getdents_stat() - directory entries along with their attributes.
+ *
+ * Entries are gathered into a kernel buffer by ->iterate() as for
+ * getdents64(), and only once the directory lock has been dropped are
+ * they looked up and stat'ed, so filesystems never see lookups from
+ * inside their readdir.
+ */
+#define DIRENT_STAT_BUF_MAX	(32 * 1024)
+
+struct getdents_stat_callback {
+	struct dir_context ctx;
+	void *buf;
+	struct linux_dirent_stat *previous;
+	unsigned int used;
+	unsigned int count;
+	int error;
+};
+
+static int filldir_stat(struct dir_context *ctx, const char *name, int namlen,
+			loff_t offset, u64 ino, unsigned int d_type)
+{
+	struct linux_dirent_stat *dirent;
+	struct getdents_stat_callback *buf =
+		container_of(ctx, struct getdents_stat_callback, ctx);
+	int reclen = ALIGN(offsetof(struct linux_dirent_stat, d_name) +
+			   namlen + 1, sizeof(u64));
+
+	buf->error = -EINVAL;	/* only used if we fail.. */
+	if (reclen > buf->count - buf->used)
+		return -EINVAL;
+	if (buf->previous)
+		buf->previous->d_off = offset;
+	dirent = buf->buf + buf->used;
+	memset(dirent, 0, reclen);
+	dirent->d_ino = ino;
+	dirent->d_reclen = reclen;
+	dirent->d_type = d_type;
+	memcpy(dirent->d_name, name, namlen);
+	buf->previous = dirent;
+	buf->used += reclen;
+	return 0;
+}
+
+/*
+ * Find the entry without a full lookup if the dcache already holds a
+ * dentry that needs no revalidation and is not covered by a mount.
+ */
+static int dirent_stat_lookup(struct path *dir, const char *name, int fast,
+			      struct path *path)
+{
+	struct qstr this = QSTR_INIT(name, strlen(name));
+	struct dentry *dentry;
+
+	if (fast) {
+		dentry = d_hash_and_lookup(dir->dentry, &this);
+		if (!IS_ERR_OR_NULL(dentry)) {
+			if (!d_is_negative(dentry) && !d_managed(dentry) &&
+			    !(dentry->d_flags & DCACHE_OP_REVALIDATE)) {
+				path->mnt = mntget(dir->mnt);
+				path->dentry = dentry;
+				return 0;
+			}
+			dput(dentry);
+		}
+	}
+	return vfs_path_lookup(dir->dentry, dir->mnt, name, 0, path);
+}
+
+static void dirent_stat_fill(struct path *dir, struct linux_dirent_stat *dirent,
+			     unsigned int mask, int fast)
+{
+	struct path path;
+	struct kstat stat;
+	int error;
+
+	/* readdir told us all we were asked for */
+	if (!(mask & ~DSTAT_TYPE) &&
+	    (!(mask & DSTAT_TYPE) || dirent->d_type != DT_UNKNOWN)) {
+		dirent->d_mask = mask;
+		return;
+	}
+
+	error = dirent_stat_lookup(dir, dirent->d_name, fast, &path);
+	if (!error) {
+		error = vfs_getattr(&path, &stat);
+		path_put(&path);
+	}
+	if (error) {
+		dirent->d_error = error;
+		if (dirent->d_type != DT_UNKNOWN)
+			dirent->d_mask = mask & DSTAT_TYPE;
+		return;
+	}
+
+	if (dirent->d_type == DT_UNKNOWN)
+		dirent->d_type = (stat.mode >> 12) & 15;
+	dirent->d_mask = mask;
+	if (mask & DSTAT_MODE)
+		dirent->st_mode = stat.mode;
+	if (mask & DSTAT_NLINK)
+		dirent->st_nlink = stat.nlink;
+	if (mask & DSTAT_UID)
+		dirent->st_uid = from_kuid_munged(current_user_ns(), stat.uid);
+	if (mask & DSTAT_GID)
+		dirent->st_gid = from_kgid_munged(current_user_ns(), stat.gid);
+	if (mask & DSTAT_RDEV)
+		dirent->st_rdev = new_encode_dev(stat.rdev);
+	if (mask & DSTAT_SIZE)
+		dirent->st_size = stat.size;
+	if (mask & DSTAT_BLOCKS) {
+		dirent->st_blocks = stat.blocks;
+		dirent->st_blksize = stat.blksize;
+	}
+	if (mask & DSTAT_ATIME) {
+		dirent->st_atime = stat.atime.tv_sec;
+		dirent->st_atime_nsec = stat.atime.tv_nsec;
+	}
+	if (mask & DSTAT_MTIME) {
+		dirent->st_mtime = stat.mtime.tv_sec;
+		dirent->st_mtime_nsec = stat.mtime.tv_nsec;
+	}
+	if (mask & DSTAT_CTIME) {
+		dirent->st_ctime = stat.ctime.tv_sec;
+		dirent->st_ctime_nsec = stat.ctime.tv_nsec;
+	}
+}
+
+SYSCALL_DEFINE5(getdents_stat, unsigned int, fd,
+		struct linux_dirent_stat __user *, dirent, unsigned int, count,
+		unsigned int, mask, unsigned int, flags)
+{
+	struct fd f;
+	struct getdents_stat_callback buf = {
+		.ctx.actor = filldir_stat,
+	};
+	unsigned int pos;
+	int error, fast;
+
+	if (flags || (mask & ~DSTAT_ALL))
+		return -EINVAL;
+	if (!access_ok(VERIFY_WRITE, dirent, count))
+		return -EFAULT;
+
+	buf.count = min_t(unsigned int, count, DIRENT_STAT_BUF_MAX);
+	buf.buf = kmalloc(buf.count, GFP_KERNEL);
+	if (!buf.buf)
+		return -ENOMEM;
+
+	error = -EBADF;
+	f = fdget(fd);
+	if (!f.file)
+		goto out_free;
+
+	error = iterate_dir(f.file, &buf.ctx);
+	if (error >= 0)
+		error = buf.error;
+	if (!buf.previous)
+		goto out_fdput;
+	buf.previous->d_off = buf.ctx.pos;
+
+	/* The dcache shortcut skips the search permission check on the way */
+	fast = !inode_permission(file_inode(f.file), MAY_EXEC);
+	for (pos = 0; pos < buf.used; ) {
+		struct linux_dirent_stat *d = buf.buf + pos;
+
+		dirent_stat_fill(&f.file->f_path, d, mask, fast);
+		pos += d->d_reclen;
+		cond_resched();
+	}
+
+	error = buf.used;
+	if (copy_to_user(dirent, buf.buf, buf.used))
+		error = -EFAULT;
+out_fdput:
+	fdput(f);
+out_free:
+	kfree(buf.buf);
+	return error;
+}
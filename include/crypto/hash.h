@@ -156,11 +156,16 @@ struct shash_desc {
  * @export: see struct ahash_alg
  * @import: see struct ahash_alg
  * @setkey: see struct ahash_alg
+ * @finup_mb: Finish the hash of several messages of the same length, each
+ *	      starting from the state in the descriptor, in parallel.  The
+ *	      descriptor itself is left untouched.  Optional; at most
+ *	      @mb_max_msgs messages are passed at once.
  * @digestsize: see struct ahash_alg
  * @statesize: see struct ahash_alg
  * @descsize: Size of the operational state for the message digest. This state
  * 	      size is the memory size that needs to be allocated for
  *	      shash_desc.__ctx
+ * @mb_max_msgs: Maximum number of messages @finup_mb handles at once.
  * @base: internally used
  */
 struct shash_alg {
@@ -176,8 +181,12 @@ struct shash_alg {
 	int (*import)(struct shash_desc *desc, const void *in);
 	int (*setkey)(struct crypto_shash *tfm, const u8 *key,
 		      unsigned int keylen);
+	int (*finup_mb)(struct shash_desc *desc, const u8 * const data[],
+			unsigned int len, u8 * const outs[],
+			unsigned int num_msgs);
 
 	unsigned int descsize;
+	unsigned int mb_max_msgs;
 
 	/* These fields must match hash_alg_common. */
 	unsigned int digestsize
@@ -847,4 +856,61 @@ int crypto_shash_final(struct shash_desc *desc, u8 *out);
 int crypto_shash_finup(struct shash_desc *desc, const u8 *data,
 		       unsigned int len, u8 *out);
 
+/**
+ * crypto_shash_mb_max_msgs() - maximum number of messages hashed in parallel
+ * @tfm: hash transformation object
+ *
+ * Return: the largest useful number of messages to pass to
+ *	   crypto_shash_finup_mb() at once; 1 if the algorithm has no
+ *	   multi-buffer support.
+ */
+static inline unsigned int crypto_shash_mb_max_msgs(struct crypto_shash *tfm)
+{
+	struct shash_alg *alg = crypto_shash_alg(tfm);
+
+	return alg->finup_mb ? alg->mb_max_msgs : 1;
+}
+
+/**
+ * crypto_shash_finup_mb() - finish hashing several messages in parallel
+ * @desc: operational state handle, already filled with the common prefix
+ * @data: the messages
+ * @len: length of each message
+ * @outs: output buffers for the message digests
+ * @num_msgs: number of messages, at most crypto_shash_mb_max_msgs()
+ *
+ * Equivalent to calling crypto_shash_finup() on a copy of @desc for each
+ * message, which is also what happens if the algorithm cannot interleave
+ * the computations.  @desc is left untouched.
+ *
+ * Return: 0 if the message digest creation was successful; < 0 if an error
+ *	   occurred
+ */
+static inline int crypto_shash_finup_mb(struct shash_desc *desc,
+					const u8 * const data[],
+					unsigned int len, u8 * const outs[],
+					unsigned int num_msgs)
+{
+	struct crypto_shash *tfm = desc->tfm;
+	struct shash_alg *alg = crypto_shash_alg(tfm);
+	unsigned int i;
+	int err;
+
+	if (alg->finup_mb && num_msgs > 1 && num_msgs <= alg->mb_max_msgs)
+		return alg->finup_mb(desc, data, len, outs, num_msgs);
+
+	for (i = 0; i < num_msgs; i++) {
+		SHASH_DESC_ON_STACK(desc2, tfm);
+
+		desc2->tfm = tfm;
+		desc2->flags = desc->flags;
+		memcpy(shash_desc_ctx(desc2), shash_desc_ctx(desc),
+		       crypto_shash_descsize(tfm));
+		err = crypto_shash_finup(desc2, data[i], len, outs[i]);
+		if (err)
+			return err;
+	}
+	return 0;
+}
+
 #endif	/* _CRYPTO_HASH_H */
@@ -12,6 +12,13 @@ struct blk_mq_cpu_notifier {
 	int (*notify)(void *data, unsigned long action, unsigned int cpu);
 };
 
+struct blk_mq_poll_stat {
+	u64 nr_samples;
+	u64 mean;		/* running average, in nsecs */
+	u64 min;
+	u64 max;
+};
+
 struct blk_mq_ctxmap {
 	unsigned int size;
 	unsigned int bits_per_word;
@@ -57,6 +64,12 @@ struct blk_mq_hw_ctx {
 
 	atomic_t		nr_active;
 
+	unsigned long		poll_considered;
+	unsigned long		poll_invoked;
+	unsigned long		poll_success;
+	unsigned long		poll_sleep;
+	struct blk_mq_poll_stat	poll_stat[2];	/* indexed by data direction */
+
 	struct blk_mq_cpu_notifier	cpu_notifier;
 	struct kobject		kobj;
 };
@@ -94,6 +107,8 @@ typedef int (init_request_fn)(void *, struct request *, unsigned int,
 typedef void (exit_request_fn)(void *, struct request *, unsigned int,
 		unsigned int);
 
+typedef int (poll_fn)(struct blk_mq_hw_ctx *);
+
 typedef void (busy_iter_fn)(struct blk_mq_hw_ctx *, struct request *, void *,
 		bool);
 
@@ -115,6 +130,13 @@ struct blk_mq_ops {
 
 	softirq_done_fn		*complete;
 
+	/*
+	 * Called to poll for completion of requests on a hardware queue.
+	 * Returns the number of requests completed, or a negative value
+	 * if polling should be stopped.
+	 */
+	poll_fn			*poll;
+
 	/*
 	 * Called when the block layer side of a hardware queue has been
 	 * set up, allowing the driver to allocate/init matching structures.
@@ -0,0 +1,56 @@
+#ifndef _LINUX_BOOT_TIMELINE_H
+#define _LINUX_BOOT_TIMELINE_H
+
+/*
+ * Boot timeline: a record of what the kernel spent its time on while
+ * booting, read back from <debugfs>/boot_timeline.
+ *
+ * Each event gets an id from boot_timeline_begin(), which must be handed
+ * back to boot_timeline_end() by the same task.  Events nest: the parent
+ * of a new event is the innermost one still open in the current task, or
+ * for async work the event that was open when the work was queued.
+ * Negative ids mean "not recorded" and are ignored by the other calls.
+ */
+
+enum boot_event_type {
+	BOOT_EVENT_INITCALL,
+	BOOT_EVENT_ASYNC,
+	BOOT_EVENT_PROBE,
+	BOOT_EVENT_DEFERRED_PROBE,
+	BOOT_EVENT_FIRMWARE,
+	BOOT_EVENT_MOUNT_ROOT,
+};
+
+#ifdef CONFIG_BOOT_TIMELINE
+extern __printf(2, 3)
+int boot_timeline_begin(enum boot_event_type type, const char *fmt, ...);
+extern __printf(3, 4)
+int boot_timeline_begin_child(enum boot_event_type type, int parent,
+			      const char *fmt, ...);
+extern void boot_timeline_end(int id, int ret);
+extern int boot_timeline_current(void);
+
+extern void boot_timeline_init(void);
+extern void boot_timeline_stop(void);
+#else
+static inline __printf(2, 3)
+int boot_timeline_begin(enum boot_event_type type, const char *fmt, ...)
+{
+	return -1;
+}
+
+static inline __printf(3, 4)
+int boot_timeline_begin_child(enum boot_event_type type, int parent,
+			      const char *fmt, ...)
+{
+	return -1;
+}
+
+static inline void boot_timeline_end(int id, int ret) { }
+static inline int boot_timeline_current(void) { return -1; }
+
+static inline void boot_timeline_init(void) { }
+static inline void boot_timeline_stop(void) { }
+#endif
+
+#endif /* _LINUX_BOOT_TIMELINE_H */
@@ -47,6 +47,8 @@ int request_firmware_nowait(
 	void (*cont)(const struct firmware *fw, void *context));
 int request_firmware_direct(const struct firmware **fw, const char *name,
 			    struct device *device);
+ssize_t request_firmware_chunk(const char *name, struct device *device,
+			       void *buf, size_t size, loff_t offset);
 
 void release_firmware(const struct firmware *fw);
 #else
@@ -75,5 +77,12 @@ static inline int request_firmware_direct(const struct firmware **fw,
 	return -EINVAL;
 }
 
+static inline ssize_t request_firmware_chunk(const char *name,
+					     struct device *device, void *buf,
+					     size_t size, loff_t offset)
+{
+	return -EINVAL;
+}
+
 #endif
 #endif
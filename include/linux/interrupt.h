@@ -119,6 +119,9 @@ struct irqaction {
 	unsigned long		thread_mask;
 	const char		*name;
 	struct proc_dir_entry	*dir;
+#ifdef CONFIG_IRQ_TIMING_STATS
+	u64			thread_woken;
+#endif
 } ____cacheline_internodealigned_in_smp;
 
 extern irqreturn_t no_action(int cpl, void *dev_id);
@@ -219,6 +222,35 @@ struct irq_affinity_notify {
 	void (*release)(struct kref *ref);
 };
 
+/**
+ * struct irq_rate_notify - context for notification of interrupt rate
+ * @notify:		Function called with the rate, in interrupts per
+ *			second, seen over the last period of about 100ms,
+ *			e.g. to adapt a device's interrupt coalescing.
+ *			Called in hard interrupt context, from the interrupt
+ *			that ends the period, so the rate isn't updated
+ *			while the interrupt is quiet.
+ */
+struct irq_rate_notify {
+	void (*notify)(struct irq_rate_notify *, unsigned int rate);
+};
+
+#ifdef CONFIG_IRQ_TIMING_STATS
+extern int irq_set_rate_notifier(unsigned int irq,
+				 struct irq_rate_notify *notify);
+extern u64 irq_timings_next_event(u64 now);
+#else
+static inline int irq_set_rate_notifier(unsigned int irq,
+					struct irq_rate_notify *notify)
+{
+	return -ENOSYS;
+}
+static inline u64 irq_timings_next_event(u64 now)
+{
+	return U64_MAX;
+}
+#endif
+
 #if defined(CONFIG_SMP)
 
 extern cpumask_var_t irq_default_affinity;
@@ -14,6 +14,42 @@ struct module;
 struct irq_desc;
 struct irq_domain;
 struct pt_regs;
+struct irq_rate_notify;
+
+#ifdef CONFIG_IRQ_TIMING_STATS
+/* Histogram bucket i counts durations below IRQ_TIMINGS_UNIT_NS << i */
+#define IRQ_TIMINGS_BUCKETS	16
+#define IRQ_TIMINGS_UNIT_NS	1024
+
+/**
+ * struct irq_timings - interrupt timing statistics, see kernel/irq/timings.c
+ * @last:		local_clock() at the last interrupt
+ * @interval:		moving average of the time between interrupts
+ * @window_start:	start of the current rate measurement period
+ * @window_count:	interrupts seen in the current period
+ * @rate:		interrupts per second over the last complete period
+ * @rate_max:		highest @rate seen
+ * @handler_total:	total time spent in the hard interrupt handlers
+ * @handler_max:	longest time spent in the handlers for one interrupt
+ * @handler_hist:	histogram of hard interrupt handler time
+ * @thread_hist:	histogram of the delay between waking an interrupt
+ *			thread and it running
+ * @rate_notify:	driver callback for adaptive coalescing
+ */
+struct irq_timings {
+	u64			last;
+	u64			interval;
+	u64			window_start;
+	unsigned int		window_count;
+	unsigned int		rate;
+	unsigned int		rate_max;
+	u64			handler_total;
+	u64			handler_max;
+	unsigned int		handler_hist[IRQ_TIMINGS_BUCKETS];
+	unsigned int		thread_hist[IRQ_TIMINGS_BUCKETS];
+	struct irq_rate_notify	*rate_notify;
+};
+#endif
 
 /**
  * struct irq_desc - interrupt descriptor
@@ -44,6 +80,7 @@ struct pt_regs;
  * @force_resume_depth:	number of irqactions on a irq descriptor with
  *			IRQF_FORCE_RESUME set
  * @dir:		/proc/irq/ procfs entry
+ * @timings:		handler time, thread latency and rate statistics
  * @name:		flow handler name for /proc/interrupts output
  */
 struct irq_desc {
@@ -83,6 +120,9 @@ struct irq_desc {
 #endif
 #ifdef CONFIG_PROC_FS
 	struct proc_dir_entry	*dir;
+#endif
+#ifdef CONFIG_IRQ_TIMING_STATS
+	struct irq_timings	timings;
 #endif
 	int			parent_irq;
 	struct module		*owner;
@@ -29,6 +29,8 @@
 #include <linux/mutex.h>
 #include <linux/timer.h>
 #include <linux/slab.h>
+#include <linux/log2.h>
+#include <linux/math64.h>
 #include <crypto/hash.h>
 #endif
 
@@ -681,6 +683,25 @@ jbd2_time_diff(unsigned long start, unsigned long end)
 	return end + (MAX_JIFFY_OFFSET - start);
 }
 
+/*
+ * Latency histograms: bucket 0 counts times below 1us, bucket n counts
+ * times in [2^(n-1), 2^n) us and the last bucket everything above.
+ */
+#define JBD2_HIST_BUCKETS	24
+
+struct jbd2_latency_hist {
+	unsigned long		buckets[JBD2_HIST_BUCKETS];
+};
+
+static inline unsigned int jbd2_hist_bucket(u64 ns)
+{
+	u64 us = div_u64(ns, NSEC_PER_USEC);
+
+	if (!us)
+		return 0;
+	return min_t(unsigned int, ilog2(us) + 1, JBD2_HIST_BUCKETS - 1);
+}
+
 #define JBD2_NR_BATCH	64
 
 /**
@@ -727,6 +748,8 @@ jbd2_time_diff(unsigned long start, unsigned long end)
  * @j_transaction_sequence: Sequence number of the next transaction to grant
  * @j_commit_sequence: Sequence number of the most recently committed
  *  transaction
+ * @j_durable_sequence: Sequence number of the most recent transaction whose
+ *  commit record is on stable storage
  * @j_commit_request: Sequence number of the most recent transaction wanting
  *     commit
  * @j_uuid: Uuid of client object.
@@ -750,6 +773,9 @@ jbd2_time_diff(unsigned long start, unsigned long end)
  * @j_history_lock: Protect the transactions statistics history
  * @j_proc_entry: procfs entry for the jbd statistics directory
  * @j_stats: Overall statistics
+ * @j_commit_hist: Histogram of transaction commit times
+ * @j_fsync_hist: Histogram of time spent waiting in
+ *     jbd2_complete_transaction_durable()
  * @j_private: An opaque pointer to fs-private information.
  */
 
@@ -903,6 +929,13 @@ struct journal_s
 	 */
 	tid_t			j_commit_sequence;
 
+	/*
+	 * Sequence number of the most recent transaction whose commit record
+	 * has reached stable storage; may run ahead of j_commit_sequence
+	 * while the commit thread is still tidying up [j_state_lock].
+	 */
+	tid_t			j_durable_sequence;
+
 	/*
 	 * Sequence number of the most recent transaction wanting commit
 	 * [j_state_lock]
@@ -978,6 +1011,8 @@ struct journal_s
 	spinlock_t		j_history_lock;
 	struct proc_dir_entry	*j_proc_entry;
 	struct transaction_stats_s j_stats;
+	struct jbd2_latency_hist j_commit_hist;
+	struct jbd2_latency_hist j_fsync_hist;
 
 	/* Failed journal commit ID */
 	unsigned int		j_failed_commit;
@@ -1244,6 +1279,7 @@ int __jbd2_log_start_commit(journal_t *journal, tid_t tid);
 int jbd2_journal_start_commit(journal_t *journal, tid_t *tid);
 int jbd2_log_wait_commit(journal_t *journal, tid_t tid);
 int jbd2_complete_transaction(journal_t *journal, tid_t tid);
+int jbd2_complete_transaction_durable(journal_t *journal, tid_t tid);
 int jbd2_log_do_checkpoint(journal_t *journal);
 int jbd2_trans_will_send_data_barrier(journal_t *journal, tid_t tid);
 
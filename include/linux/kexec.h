@@ -308,6 +308,23 @@ extern size_t vmcoreinfo_max_size;
 /* flag to track if kexec reboot is in progress */
 extern bool kexec_in_progress;
 
+/*
+ * A region of memory whose contents are handed over to the next kernel,
+ * e.g. state that is slow to rebuild.  See kexec_preserve_region().
+ */
+struct kexec_preserved {
+	struct list_head	list;
+	const char		*label;
+	phys_addr_t		base;
+	phys_addr_t		size;
+};
+
+extern struct list_head kexec_preserved_list;
+
+int kexec_preserve_region(struct kexec_preserved *region);
+void kexec_unpreserve_region(struct kexec_preserved *region);
+ssize_t kexec_preserved_show(char *buf);
+
 int __init parse_crashkernel(char *cmdline, unsigned long long system_ram,
 		unsigned long long *crash_size, unsigned long long *crash_base);
 int parse_crashkernel_high(char *cmdline, unsigned long long system_ram,
@@ -323,6 +340,13 @@ struct pt_regs;
 struct task_struct;
 static inline void crash_kexec(struct pt_regs *regs) { }
 static inline int kexec_should_crash(struct task_struct *p) { return 0; }
+
+struct kexec_preserved;
+static inline int kexec_preserve_region(struct kexec_preserved *region)
+{
+	return 0;
+}
+static inline void kexec_unpreserve_region(struct kexec_preserved *region) { }
 #endif /* CONFIG_KEXEC */
 
 #endif /* !defined(__ASSEBMLY__) */
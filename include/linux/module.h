@@ -262,6 +262,11 @@ struct module {
 	const unsigned long *gpl_future_crcs;
 	unsigned int num_gpl_future_syms;
 
+#ifdef CONFIG_MODULE_SYMBOL_HASH
+	/* Our exports in the global symbol hash */
+	struct ksym_index *ksym_index;
+#endif
+
 	/* Exception table */
 	unsigned int num_exentries;
 	struct exception_table_entry *extable;
@@ -31,6 +31,9 @@ typedef int (*reservedmem_of_init_fn)(struct reserved_mem *rmem);
 int of_reserved_mem_device_init(struct device *dev);
 void of_reserved_mem_device_release(struct device *dev);
 
+struct reserved_mem *of_reserved_mem_lookup_preserved(const char *label);
+void of_reserved_mem_release_preserved(struct reserved_mem *rmem);
+
 void fdt_init_reserved_mem(void);
 void fdt_reserved_mem_save_node(unsigned long node, const char *uname,
 			       phys_addr_t base, phys_addr_t size);
@@ -41,6 +44,13 @@ static inline int of_reserved_mem_device_init(struct device *dev)
 }
 static inline void of_reserved_mem_device_release(struct device *pdev) { }
 
+static inline struct reserved_mem *
+of_reserved_mem_lookup_preserved(const char *label)
+{
+	return NULL;
+}
+static inline void of_reserved_mem_release_preserved(struct reserved_mem *rmem) { }
+
 static inline void fdt_init_reserved_mem(void) { }
 static inline void fdt_reserved_mem_save_node(unsigned long node,
 		const char *uname, phys_addr_t base, phys_addr_t size) { }
@@ -98,6 +98,16 @@ extern void * memset(void *,int,__kernel_size_t);
 #ifndef __HAVE_ARCH_MEMCPY
 extern void * memcpy(void *,const void *,__kernel_size_t);
 #endif
+#ifndef __HAVE_ARCH_MEMCPY_LARGE
+/*
+ * memcpy() of a potentially large buffer outside interrupt context, which
+ * an architecture may do with vector registers that memcpy() can't use.
+ */
+static inline void *memcpy_large(void *dest, const void *src, size_t count)
+{
+	return memcpy(dest, src, count);
+}
+#endif
 #ifndef __HAVE_ARCH_MEMMOVE
 extern void * memmove(void *,const void *,__kernel_size_t);
 #endif
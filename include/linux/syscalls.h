@@ -22,6 +22,7 @@ struct itimerval;
 struct kexec_segment;
 struct linux_dirent;
 struct linux_dirent64;
+struct linux_dirent_stat;
 struct list_head;
 struct mmap_arg_struct;
 struct msgbuf;
@@ -591,6 +592,10 @@ asmlinkage long sys_getdents(unsigned int fd,
 asmlinkage long sys_getdents64(unsigned int fd,
 				struct linux_dirent64 __user *dirent,
 				unsigned int count);
+asmlinkage long sys_getdents_stat(unsigned int fd,
+				struct linux_dirent_stat __user *dirent,
+				unsigned int count, unsigned int mask,
+				unsigned int flags);
 
 asmlinkage long sys_setsockopt(int fd, int level, int optname,
 				char __user *optval, int optlen);
@@ -38,6 +38,38 @@ DEFINE_EVENT(cpu, cpu_idle,
 	TP_ARGS(state, cpu_id)
 );
 
+TRACE_EVENT(cpu_idle_predict,
+
+	TP_PROTO(unsigned int cpu_id, unsigned int state,
+		 unsigned int timer_us, unsigned int irq_us,
+		 unsigned int measured_us),
+
+	TP_ARGS(cpu_id, state, timer_us, irq_us, measured_us),
+
+	TP_STRUCT__entry(
+		__field(	u32,		cpu_id		)
+		__field(	u32,		state		)
+		__field(	u32,		timer_us	)
+		__field(	u32,		irq_us		)
+		__field(	u32,		measured_us	)
+	),
+
+	TP_fast_assign(
+		__entry->cpu_id = cpu_id;
+		__entry->state = state;
+		__entry->timer_us = timer_us;
+		__entry->irq_us = irq_us;
+		__entry->measured_us = measured_us;
+	),
+
+	TP_printk("cpu_id=%lu state=%lu timer_us=%lu irq_us=%lu measured_us=%lu",
+		  (unsigned long)__entry->cpu_id,
+		  (unsigned long)__entry->state,
+		  (unsigned long)__entry->timer_us,
+		  (unsigned long)__entry->irq_us,
+		  (unsigned long)__entry->measured_us)
+);
+
 TRACE_EVENT(pstate_sample,
 
 	TP_PROTO(u32 core_busy,
@@ -0,0 +1,55 @@
+#ifndef _UAPI_LINUX_DIRENT_STAT_H
+#define _UAPI_LINUX_DIRENT_STAT_H
+
+#include <linux/types.h>
+
+/*
+ * Attributes that can be requested from getdents_stat(2).  The inode
+ * number is always returned; DSTAT_TYPE only costs a lookup on
+ * filesystems that don't report the file type from readdir.
+ */
+#define DSTAT_TYPE	0x00000001
+#define DSTAT_MODE	0x00000002
+#define DSTAT_NLINK	0x00000004
+#define DSTAT_UID	0x00000008
+#define DSTAT_GID	0x00000010
+#define DSTAT_RDEV	0x00000020
+#define DSTAT_SIZE	0x00000040
+#define DSTAT_BLOCKS	0x00000080
+#define DSTAT_ATIME	0x00000100
+#define DSTAT_MTIME	0x00000200
+#define DSTAT_CTIME	0x00000400
+#define DSTAT_ALL	0x000007ff
+
+/*
+ * One record per directory entry, d_reclen bytes long.  The layout is
+ * the same for 32-bit and 64-bit userspace.  Attributes are those of the
+ * entry itself, as with lstat(2); d_mask says which of them are valid,
+ * and d_error holds a negative errno if the entry could not be looked up.
+ */
+struct linux_dirent_stat {
+	__u64	d_ino;
+	__s64	d_off;
+	__u16	d_reclen;
+	__u8	d_type;
+	__u8	d_pad;
+	__u32	d_mask;
+	__s32	d_error;
+	__u32	st_mode;
+	__u32	st_nlink;
+	__u32	st_uid;
+	__u32	st_gid;
+	__u32	st_rdev;
+	__u32	st_blksize;
+	__u32	st_atime_nsec;
+	__u32	st_mtime_nsec;
+	__u32	st_ctime_nsec;
+	__u64	st_size;
+	__u64	st_blocks;
+	__s64	st_atime;
+	__s64	st_mtime;
+	__s64	st_ctime;
+	char	d_name[0];
+};
+
+#endif /* _UAPI_LINUX_DIRENT_STAT_H */
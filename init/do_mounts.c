@@ -24,6 +24,7 @@
 #include <linux/fs.h>
 #include <linux/initrd.h>
 #include <linux/async.h>
+#include <linux/boot_timeline.h>
 #include <linux/fs_struct.h>
 #include <linux/slab.h>
 #include <linux/ramfs.h>
@@ -544,6 +545,12 @@ void __init mount_root(void)
 void __init prepare_namespace(void)
 {
 	int is_floppy;
+	int event;
+
+	/* Includes waiting for probes to finish and for the root device */
+	event = boot_timeline_begin(BOOT_EVENT_MOUNT_ROOT, "%s",
+				    saved_root_name[0] ? saved_root_name :
+							 "initrd");
 
 	if (root_delay) {
 		printk(KERN_INFO "Waiting %d sec before mounting root device...\n",
@@ -597,6 +604,7 @@ out:
 	devtmpfs_mount("dev");
 	sys_mount(".", "/", NULL, MS_MOVE, NULL);
 	sys_chroot(".");
+	boot_timeline_end(event, 0);
 }
 
 static bool is_tmpfs;
@@ -58,6 +58,7 @@
 #include <linux/kmemleak.h>
 #include <linux/pid_namespace.h>
 #include <linux/device.h>
+#include <linux/boot_timeline.h>
 #include <linux/kthread.h>
 #include <linux/sched.h>
 #include <linux/signal.h>
@@ -776,16 +777,18 @@ static int __init_or_module do_one_initcall_debug(initcall_t fn)
 int __init_or_module do_one_initcall(initcall_t fn)
 {
 	int count = preempt_count();
-	int ret;
+	int ret, event;
 	char msgbuf[64];
 
 	if (initcall_blacklisted(fn))
 		return -EPERM;
 
+	event = boot_timeline_begin(BOOT_EVENT_INITCALL, "%pf", fn);
 	if (initcall_debug)
 		ret = do_one_initcall_debug(fn);
 	else
 		ret = fn();
+	boot_timeline_end(event, ret);
 
 	msgbuf[0] = 0;
 
@@ -931,6 +934,7 @@ static int __ref kernel_init(void *unused)
 	kernel_init_freeable();
 	/* need to finish all async __init code before freeing the memory */
 	async_synchronize_full();
+	boot_timeline_stop();
 	free_initmem();
 	mark_rodata_ro();
 	system_state = SYSTEM_RUNNING;
@@ -990,6 +994,8 @@ static noinline void __init kernel_init_freeable(void)
 
 	cad_pid = task_pid(current);
 
+	boot_timeline_init();
+
 	smp_prepare_cpus(setup_max_cpus);
 
 	do_pre_smp_initcalls();
@@ -49,6 +49,7 @@ asynchronous and synchronous parts of the kernel.
 */
 
 #include <linux/async.h>
+#include <linux/boot_timeline.h>
 #include <linux/atomic.h>
 #include <linux/ktime.h>
 #include <linux/export.h>
@@ -76,6 +77,7 @@ struct async_entry {
 	async_func_t		func;
 	void			*data;
 	struct async_domain	*domain;
+	int			boot_event;	/* boot timeline parent */
 };
 
 static DECLARE_WAIT_QUEUE_HEAD(async_done);
@@ -112,6 +114,7 @@ static void async_run_entry_fn(struct work_struct *work)
 		container_of(work, struct async_entry, work);
 	unsigned long flags;
 	ktime_t uninitialized_var(calltime), delta, rettime;
+	int event;
 
 	/* 1) run (and print duration) */
 	if (initcall_debug && system_state == SYSTEM_BOOTING) {
@@ -120,7 +123,10 @@ static void async_run_entry_fn(struct work_struct *work)
 			entry->func, task_pid_nr(current));
 		calltime = ktime_get();
 	}
+	event = boot_timeline_begin_child(BOOT_EVENT_ASYNC, entry->boot_event,
+					  "%pf", entry->func);
 	entry->func(entry->data, entry->cookie);
+	boot_timeline_end(event, 0);
 	if (initcall_debug && system_state == SYSTEM_BOOTING) {
 		rettime = ktime_get();
 		delta = ktime_sub(rettime, calltime);
@@ -174,6 +180,7 @@ static async_cookie_t __async_schedule(async_func_t func, void *data, struct asy
 	entry->func = func;
 	entry->data = data;
 	entry->domain = domain;
+	entry->boot_event = boot_timeline_current();
 
 	spin_lock_irqsave(&async_lock, flags);
 
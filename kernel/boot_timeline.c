@@ -0,0 +1,274 @@
+/*
+ * Boot timeline
+ *
+ * Records initcalls, async work, driver probes, deferred probe retries,
+ * firmware loads and the root mount from the start of the initcalls
+ * until init is about to be started, and exports them through debugfs
+ * as one event per line:
+ *
+ *   id parent type start_ns end_ns ret pid name
+ *
+ * Times are local_clock() nanoseconds, the same clock as the printk
+ * timestamps.  end_ns is "-" for events that never finished, parent is
+ * -1 for top level events.
+ *
+ * Released under the GPL version 2 only.
+ */
+
+#include <linux/boot_timeline.h>
+#include <linux/debugfs.h>
+#include <linux/init.h>
+#include <linux/kernel.h>
+#include <linux/list.h>
+#include <linux/sched.h>
+#include <linux/seq_file.h>
+#include <linux/spinlock.h>
+#include <linux/vmalloc.h>
+
+#define BOOT_EVENT_NAME_LEN	48
+
+struct boot_event {
+	u64			start;
+	u64			end;
+	struct list_head	open;	/* on boot_open_events until ended */
+	struct task_struct	*task;
+	pid_t			pid;
+	int			parent;
+	int			ret;
+	enum boot_event_type	type;
+	char			name[BOOT_EVENT_NAME_LEN];
+};
+
+static const char * const boot_event_names[] = {
+	[BOOT_EVENT_INITCALL]		= "initcall",
+	[BOOT_EVENT_ASYNC]		= "async",
+	[BOOT_EVENT_PROBE]		= "probe",
+	[BOOT_EVENT_DEFERRED_PROBE]	= "deferred",
+	[BOOT_EVENT_FIRMWARE]		= "firmware",
+	[BOOT_EVENT_MOUNT_ROOT]		= "rootfs",
+};
+
+static unsigned int boot_events_max = 2048;
+static struct boot_event *boot_events;
+static unsigned int boot_events_nr;
+static unsigned int boot_events_dropped;
+static bool boot_timeline_recording;
+static LIST_HEAD(boot_open_events);
+static DEFINE_SPINLOCK(boot_timeline_lock);
+
+static int __init boot_timeline_setup(char *str)
+{
+	return kstrtouint(str, 0, &boot_events_max) == 0;
+}
+__setup("boot_timeline_entries=", boot_timeline_setup);
+
+/* Innermost open event of the current task; call with the lock held */
+static int __boot_timeline_current(void)
+{
+	struct boot_event *ev;
+
+	list_for_each_entry(ev, &boot_open_events, open)
+		if (ev->task == current)
+			return ev - boot_events;
+
+	return -1;
+}
+
+int boot_timeline_current(void)
+{
+	unsigned long flags;
+	int id;
+
+	if (!READ_ONCE(boot_timeline_recording))
+		return -1;
+
+	spin_lock_irqsave(&boot_timeline_lock, flags);
+	id = __boot_timeline_current();
+	spin_unlock_irqrestore(&boot_timeline_lock, flags);
+
+	return id;
+}
+
+static int boot_timeline_vbegin(enum boot_event_type type, int parent,
+				bool inherit, const char *fmt, va_list args)
+{
+	struct boot_event *ev;
+	unsigned long flags;
+	int id = -1;
+
+	if (!READ_ONCE(boot_timeline_recording))
+		return -1;
+
+	spin_lock_irqsave(&boot_timeline_lock, flags);
+	if (!boot_timeline_recording)
+		goto out;
+	if (boot_events_nr == boot_events_max) {
+		boot_events_dropped++;
+		goto out;
+	}
+
+	id = boot_events_nr++;
+	ev = &boot_events[id];
+	ev->parent = inherit ? __boot_timeline_current() : parent;
+	ev->task = current;
+	ev->pid = task_pid_nr(current);
+	ev->type = type;
+	ev->ret = 0;
+	ev->end = 0;
+	vsnprintf(ev->name, sizeof(ev->name), fmt, args);
+	list_add(&ev->open, &boot_open_events);
+	ev->start = local_clock();
+out:
+	spin_unlock_irqrestore(&boot_timeline_lock, flags);
+	return id;
+}
+
+int boot_timeline_begin(enum boot_event_type type, const char *fmt, ...)
+{
+	va_list args;
+	int id;
+
+	va_start(args, fmt);
+	id = boot_timeline_vbegin(type, -1, true, fmt, args);
+	va_end(args);
+
+	return id;
+}
+
+int boot_timeline_begin_child(enum boot_event_type type, int parent,
+			      const char *fmt, ...)
+{
+	va_list args;
+	int id;
+
+	va_start(args, fmt);
+	id = boot_timeline_vbegin(type, parent, false, fmt, args);
+	va_end(args);
+
+	return id;
+}
+
+void boot_timeline_end(int id, int ret)
+{
+	struct boot_event *ev;
+	unsigned long flags;
+	u64 now = local_clock();
+
+	if (id < 0)
+		return;
+
+	spin_lock_irqsave(&boot_timeline_lock, flags);
+	ev = &boot_events[id];
+	if (!list_empty(&ev->open)) {
+		ev->end = now;
+		ev->ret = ret;
+		list_del_init(&ev->open);
+	}
+	spin_unlock_irqrestore(&boot_timeline_lock, flags);
+}
+
+void __init boot_timeline_init(void)
+{
+	if (!boot_events_max)
+		return;
+
+	boot_events = vzalloc(boot_events_max * sizeof(*boot_events));
+	if (!boot_events) {
+		pr_warn("boot_timeline: can't allocate %u events\n",
+			boot_events_max);
+		return;
+	}
+
+	WRITE_ONCE(boot_timeline_recording, true);
+}
+
+/*
+ * Called once init is about to run.  Events still open stay in the list
+ * so that they don't confuse anyone calling boot_timeline_end() later.
+ */
+void boot_timeline_stop(void)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&boot_timeline_lock, flags);
+	boot_timeline_recording = false;
+	spin_unlock_irqrestore(&boot_timeline_lock, flags);
+
+	if (boot_events_dropped)
+		pr_info("boot_timeline: %u events dropped, boot with boot_timeline_entries=%u or more\n",
+			boot_events_dropped,
+			boot_events_nr + boot_events_dropped);
+}
+
+static void *boot_timeline_start(struct seq_file *m, loff_t *pos)
+{
+	if (!*pos)
+		return SEQ_START_TOKEN;
+
+	return *pos <= READ_ONCE(boot_events_nr) ? &boot_events[*pos - 1] :
+						   NULL;
+}
+
+static void *boot_timeline_next(struct seq_file *m, void *v, loff_t *pos)
+{
+	++*pos;
+	return boot_timeline_start(m, pos);
+}
+
+static void boot_timeline_seq_stop(struct seq_file *m, void *v)
+{
+}
+
+static int boot_timeline_show(struct seq_file *m, void *v)
+{
+	struct boot_event *ev = v;
+	u64 end;
+
+	if (v == SEQ_START_TOKEN) {
+		seq_puts(m, "# id parent type start_ns end_ns ret pid name\n");
+		return 0;
+	}
+
+	end = READ_ONCE(ev->end);
+	seq_printf(m, "%td %d %s %llu ", ev - boot_events, ev->parent,
+		   boot_event_names[ev->type], ev->start);
+	if (end)
+		seq_printf(m, "%llu", end);
+	else
+		seq_putc(m, '-');
+	seq_printf(m, " %d %d %s\n", ev->ret, ev->pid, ev->name);
+
+	return 0;
+}
+
+static const struct seq_operations boot_timeline_seq_ops = {
+	.start	= boot_timeline_start,
+	.next	= boot_timeline_next,
+	.stop	= boot_timeline_seq_stop,
+	.show	= boot_timeline_show,
+};
+
+static int boot_timeline_open(struct inode *inode, struct file *file)
+{
+	return seq_open(file, &boot_timeline_seq_ops);
+}
+
+static const struct file_operations boot_timeline_fops = {
+	.open		= boot_timeline_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= seq_release,
+};
+
+static int __init boot_timeline_debugfs_init(void)
+{
+	if (!boot_events)
+		return 0;
+
+	if (!debugfs_create_file("boot_timeline", S_IRUSR, NULL, NULL,
+				 &boot_timeline_fops))
+		return -ENOMEM;
+
+	return 0;
+}
+late_initcall(boot_timeline_debugfs_init);
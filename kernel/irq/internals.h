@@ -110,6 +110,28 @@ static inline void unregister_handler_proc(unsigned int irq,
 					   struct irqaction *action) { }
 #endif
 
+#ifdef CONFIG_IRQ_TIMING_STATS
+extern void irq_timings_handled(struct irq_desc *desc, u64 start);
+extern void irq_timings_thread_woken(struct irqaction *action);
+extern void irq_timings_thread_run(struct irq_desc *desc,
+				   struct irqaction *action);
+extern void irq_timings_reset(struct irq_desc *desc);
+
+static inline u64 irq_timings_start(void)
+{
+	return local_clock();
+}
+#else
+static inline u64 irq_timings_start(void)
+{
+	return 0;
+}
+static inline void irq_timings_handled(struct irq_desc *desc, u64 start) { }
+static inline void irq_timings_thread_woken(struct irqaction *action) { }
+static inline void irq_timings_thread_run(struct irq_desc *desc,
+					  struct irqaction *action) { }
+#endif
+
 extern int irq_select_affinity_usr(unsigned int irq, struct cpumask *mask);
 
 extern void irq_set_thread_affinity(struct irq_desc *desc);
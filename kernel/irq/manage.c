@@ -903,6 +903,7 @@ static int irq_thread(void *data)
 		irqreturn_t action_ret;
 
 		irq_thread_check_affinity(desc, action);
+		irq_timings_thread_run(desc, action);
 
 		action_ret = handler_fn(desc, action);
 		if (action_ret == IRQ_HANDLED)
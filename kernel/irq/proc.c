@@ -280,6 +280,67 @@ static const struct file_operations irq_spurious_proc_fops = {
 	.release	= single_release,
 };
 
+#ifdef CONFIG_IRQ_TIMING_STATS
+static void irq_timings_show_hist(struct seq_file *m, const char *name,
+				  const unsigned int *hist)
+{
+	int i;
+
+	seq_printf(m, "%-12s", name);
+	for (i = 0; i < IRQ_TIMINGS_BUCKETS; i++)
+		seq_printf(m, " %u", hist[i]);
+	seq_putc(m, '\n');
+}
+
+static int irq_timings_proc_show(struct seq_file *m, void *v)
+{
+	struct irq_desc *desc = irq_to_desc((long) m->private);
+	struct irq_timings t = desc->timings;
+	int i;
+
+	seq_printf(m, "rate %u/s\n" "rate_max %u/s\n" "interval %llu ns\n"
+		   "handler_total %llu ns\n" "handler_max %llu ns\n",
+		   t.rate, t.rate_max, t.interval,
+		   t.handler_total, t.handler_max);
+
+	/* histograms, one column per bucket, labelled by its upper bound */
+	seq_printf(m, "%-12s", "below_ns");
+	for (i = 0; i < IRQ_TIMINGS_BUCKETS - 1; i++)
+		seq_printf(m, " %u", IRQ_TIMINGS_UNIT_NS << i);
+	seq_puts(m, " -\n");
+	irq_timings_show_hist(m, "handler", t.handler_hist);
+	irq_timings_show_hist(m, "thread_delay", t.thread_hist);
+	return 0;
+}
+
+/* Writing anything clears the statistics */
+static ssize_t irq_timings_proc_write(struct file *file,
+		const char __user *buffer, size_t count, loff_t *pos)
+{
+	struct irq_desc *desc = irq_to_desc((long)PDE_DATA(file_inode(file)));
+	unsigned long flags;
+
+	raw_spin_lock_irqsave(&desc->lock, flags);
+	irq_timings_reset(desc);
+	raw_spin_unlock_irqrestore(&desc->lock, flags);
+
+	return count;
+}
+
+static int irq_timings_proc_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, irq_timings_proc_show, PDE_DATA(inode));
+}
+
+static const struct file_operations irq_timings_proc_fops = {
+	.open		= irq_timings_proc_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+	.write		= irq_timings_proc_write,
+};
+#endif
+
 #define MAX_NAMELEN 128
 
 static int name_unique(unsigned int irq, struct irqaction *new_action)
@@ -355,6 +416,11 @@ void register_irq_proc(unsigned int irq, struct irq_desc *desc)
 
 	proc_create_data("spurious", 0444, desc->dir,
 			 &irq_spurious_proc_fops, (void *)(long)irq);
+
+#ifdef CONFIG_IRQ_TIMING_STATS
+	proc_create_data("timings", 0644, desc->dir,
+			 &irq_timings_proc_fops, (void *)(long)irq);
+#endif
 }
 
 void unregister_irq_proc(unsigned int irq, struct irq_desc *desc)
@@ -370,6 +436,9 @@ void unregister_irq_proc(unsigned int irq, struct irq_desc *desc)
 	remove_proc_entry("node", desc->dir);
 #endif
 	remove_proc_entry("spurious", desc->dir);
+#ifdef CONFIG_IRQ_TIMING_STATS
+	remove_proc_entry("timings", desc->dir);
+#endif
 
 	memset(name, 0, MAX_NAMELEN);
 	sprintf(name, "%u", irq);
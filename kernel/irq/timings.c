@@ -0,0 +1,215 @@
+/*
+ * linux/kernel/irq/timings.c
+ *
+ * Per interrupt timing statistics: how long the hard interrupt handlers
+ * take, how long woken interrupt threads wait for the CPU, and the rate
+ * at which the interrupt fires.  Shown in /proc/irq/<irq>/timings.
+ *
+ * Only interrupts going through handle_irq_event() are measured, per-CPU
+ * interrupts are not.  The statistics are updated without locking from
+ * the hard interrupt and from the interrupt threads, so the thread
+ * histogram of a shared interrupt can lose the odd count.
+ *
+ * Each CPU also remembers the last few interrupts it handled, so that the
+ * idle governor can guess when the next one is due.
+ */
+
+#include <linux/irq.h>
+#include <linux/interrupt.h>
+#include <linux/math64.h>
+#include <linux/percpu.h>
+#include <linux/sched.h>
+
+#include "internals.h"
+
+/* Period over which the interrupt rate is measured */
+#define IRQ_TIMINGS_WINDOW_NS	(NSEC_PER_SEC / 10)
+
+/*
+ * Interrupts remembered per CPU for irq_timings_next_event(), and how many
+ * of its average intervals an interrupt may stay away before it is no
+ * longer expected.
+ */
+#define IRQ_TIMINGS_SLOTS	8
+#define IRQ_TIMINGS_STALE	4
+
+struct irq_timings_slot {
+	unsigned int		irq;
+	u64			last;
+	u64			interval;
+};
+
+static DEFINE_PER_CPU(struct irq_timings_slot,
+		      irq_timings_slots[IRQ_TIMINGS_SLOTS]);
+
+static inline unsigned int irq_timings_bucket(u64 ns)
+{
+	unsigned int bucket = fls64(ns / IRQ_TIMINGS_UNIT_NS);
+
+	return min_t(unsigned int, bucket, IRQ_TIMINGS_BUCKETS - 1);
+}
+
+static void irq_timings_rate(struct irq_timings *t, u64 now)
+{
+	u64 elapsed = now - t->window_start;
+	struct irq_rate_notify *notify;
+
+	t->window_count++;
+	if (elapsed < IRQ_TIMINGS_WINDOW_NS)
+		return;
+
+	t->rate = div64_u64((u64)t->window_count * NSEC_PER_SEC, elapsed);
+	t->rate_max = max(t->rate, t->rate_max);
+	t->window_start = now;
+	t->window_count = 0;
+
+	/* irq_set_rate_notifier() may clear it concurrently */
+	notify = READ_ONCE(t->rate_notify);
+	if (notify)
+		notify->notify(notify, t->rate);
+}
+
+/*
+ * Remember @desc's latest arrival, replacing the interrupt seen longest
+ * ago.  Timer interrupts are left out, the idle governor knows when the
+ * next timer expires.
+ */
+static void irq_timings_remember(struct irq_desc *desc)
+{
+	struct irq_timings_slot *slot = this_cpu_ptr(irq_timings_slots);
+	struct irq_timings_slot *s = slot;
+	int i;
+
+	if (desc->action && (desc->action->flags & __IRQF_TIMER))
+		return;
+
+	for (i = 0; i < IRQ_TIMINGS_SLOTS; i++) {
+		if (slot[i].irq == desc->irq_data.irq && slot[i].last) {
+			s = &slot[i];
+			break;
+		}
+		if (slot[i].last < s->last)
+			s = &slot[i];
+	}
+
+	s->irq = desc->irq_data.irq;
+	s->last = desc->timings.last;
+	s->interval = desc->timings.interval;
+}
+
+/**
+ *	irq_timings_next_event - predict the next interrupt on this CPU
+ *	@now:	Current local_clock() time
+ *
+ *	Assumes that each of the interrupts recently handled by this CPU
+ *	keeps arriving at its average interval, and returns the local_clock()
+ *	time at which the first of them is expected, or U64_MAX if none is.
+ *	Must be called with interrupts disabled.
+ */
+u64 irq_timings_next_event(u64 now)
+{
+	struct irq_timings_slot *slot = this_cpu_ptr(irq_timings_slots);
+	u64 next, next_event = U64_MAX;
+	int i;
+
+	for (i = 0; i < IRQ_TIMINGS_SLOTS; i++) {
+		u64 interval = slot[i].interval;
+		u64 since = now - slot[i].last;
+
+		if (!slot[i].last || !interval ||
+		    since > interval * IRQ_TIMINGS_STALE)
+			continue;
+
+		/* the first arrival still to come, if some were missed */
+		next = slot[i].last + interval;
+		if (next <= now)
+			next += div64_u64(since, interval) * interval;
+		next_event = min(next_event, next);
+	}
+
+	return next_event;
+}
+
+/*
+ * Account an interrupt whose handlers started running at @start, called
+ * from handle_irq_event() once they are done.
+ */
+void irq_timings_handled(struct irq_desc *desc, u64 start)
+{
+	struct irq_timings *t = &desc->timings;
+	u64 now = local_clock();
+	u64 duration = now - start;
+
+	t->handler_total += duration;
+	t->handler_max = max(t->handler_max, duration);
+	t->handler_hist[irq_timings_bucket(duration)]++;
+
+	if (t->last) {
+		s64 diff = start - t->last - t->interval;
+
+		/* moving average, weighing the latest interval by 1/8 */
+		t->interval += div_s64(diff, 8);
+	}
+	t->last = start;
+
+	irq_timings_remember(desc);
+	irq_timings_rate(t, now);
+}
+
+void irq_timings_thread_woken(struct irqaction *action)
+{
+	action->thread_woken = local_clock();
+}
+
+/* Account the delay between waking @action's thread and it running */
+void irq_timings_thread_run(struct irq_desc *desc, struct irqaction *action)
+{
+	u64 woken = action->thread_woken;
+
+	if (!woken)
+		return;
+	desc->timings.thread_hist[irq_timings_bucket(local_clock() - woken)]++;
+	action->thread_woken = 0;
+}
+
+/* Forget everything but the rate notifier */
+void irq_timings_reset(struct irq_desc *desc)
+{
+	struct irq_rate_notify *notify = desc->timings.rate_notify;
+
+	memset(&desc->timings, 0, sizeof(desc->timings));
+	WRITE_ONCE(desc->timings.rate_notify, notify);
+}
+
+/**
+ *	irq_set_rate_notifier - control notification of interrupt rate
+ *	@irq:		Interrupt for which to enable/disable notification
+ *	@notify:	Context for notification, or %NULL to disable
+ *			notification.
+ *
+ *	Lets a driver adapt its device's interrupt coalescing to the
+ *	observed rate.  Must be called in process context.  Notification
+ *	may only be enabled after the IRQ is requested and must be
+ *	disabled before it is freed; once this returns with %NULL, the
+ *	previous callback is not running any more.
+ */
+int irq_set_rate_notifier(unsigned int irq, struct irq_rate_notify *notify)
+{
+	struct irq_desc *desc = irq_to_desc(irq);
+	unsigned long flags;
+
+	might_sleep();
+
+	if (!desc || irq_settings_is_per_cpu_devid(desc))
+		return -EINVAL;
+
+	raw_spin_lock_irqsave(&desc->lock, flags);
+	WRITE_ONCE(desc->timings.rate_notify, notify);
+	raw_spin_unlock_irqrestore(&desc->lock, flags);
+
+	if (!notify)
+		synchronize_irq(irq);
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(irq_set_rate_notifier);
@@ -57,6 +57,20 @@ size_t vmcoreinfo_max_size = sizeof(vmcoreinfo_data);
 /* Flag to indicate we are going to kexec a new kernel */
 bool kexec_in_progress = false;
 
+/* Regions handed over to the next kernel, protected by kexec_mutex */
+LIST_HEAD(kexec_preserved_list);
+
+static bool kexec_overlaps_preserved(unsigned long mstart, unsigned long mend)
+{
+	struct kexec_preserved *region;
+
+	list_for_each_entry(region, &kexec_preserved_list, list)
+		if ((mend > region->base) &&
+		    (mstart < region->base + region->size))
+			return true;
+	return false;
+}
+
 /*
  * Declare these symbols weak so that if architecture provides a purgatory,
  * these will be overridden.
@@ -210,6 +224,19 @@ static int sanity_check_segment_list(struct kimage *image)
 		}
 	}
 
+	/* Nor may they land on memory that is being preserved for
+	 * the next kernel, or its contents would be lost on the way.
+	 */
+	result = -EBUSY;
+	for (i = 0; i < nr_segments; i++) {
+		unsigned long mstart, mend;
+
+		mstart = image->segment[i].mem;
+		mend   = mstart + image->segment[i].memsz;
+		if (kexec_overlaps_preserved(mstart, mend))
+			return result;
+	}
+
 	/* Ensure our buffer sizes are strictly less than
 	 * our memory sizes.  This should always be the case,
 	 * and it is easier to check up front than to be surprised
@@ -1482,6 +1509,74 @@ void crash_kexec(struct pt_regs *regs)
 	}
 }
 
+/**
+ * kexec_preserve_region - keep a memory region intact across kexec
+ * @region: region to preserve, owned by the caller until it is removed
+ *
+ * The region is listed in /sys/kernel/kexec_preserved_regions so that the
+ * kexec tools can describe it to the next kernel as a /reserved-memory
+ * node compatible with "linux,kexec-preserved" and labelled with
+ * @region->label, see of_reserved_mem_lookup_preserved().  Images
+ * may not be loaded over a preserved region; -EBUSY is returned if the
+ * currently loaded one already is.
+ *
+ * Only the loaded segments are kept away from the region.  Code that runs
+ * before the next kernel has parsed its DTB, such as the ARM zImage
+ * decompressor, may still use memory near the start of RAM, so regions
+ * are best allocated towards the end of it.
+ */
+int kexec_preserve_region(struct kexec_preserved *region)
+{
+	struct kimage *image;
+	unsigned long i;
+	int ret = 0;
+
+	if (!region->size || !PAGE_ALIGNED(region->base) ||
+	    !PAGE_ALIGNED(region->size))
+		return -EINVAL;
+
+	mutex_lock(&kexec_mutex);
+	image = kexec_image;
+	for (i = 0; image && i < image->nr_segments; i++) {
+		unsigned long mstart, mend;
+
+		mstart = image->segment[i].mem;
+		mend   = mstart + image->segment[i].memsz;
+		if ((mend > region->base) &&
+		    (mstart < region->base + region->size)) {
+			ret = -EBUSY;
+			goto out;
+		}
+	}
+	list_add_tail(&region->list, &kexec_preserved_list);
+out:
+	mutex_unlock(&kexec_mutex);
+	return ret;
+}
+EXPORT_SYMBOL_GPL(kexec_preserve_region);
+
+void kexec_unpreserve_region(struct kexec_preserved *region)
+{
+	mutex_lock(&kexec_mutex);
+	list_del(&region->list);
+	mutex_unlock(&kexec_mutex);
+}
+EXPORT_SYMBOL_GPL(kexec_unpreserve_region);
+
+/* One "label base size" line per preserved region, for sysfs */
+ssize_t kexec_preserved_show(char *buf)
+{
+	struct kexec_preserved *region;
+	ssize_t len = 0;
+
+	mutex_lock(&kexec_mutex);
+	list_for_each_entry(region, &kexec_preserved_list, list)
+		len += scnprintf(buf + len, PAGE_SIZE - len, "%s %pa %pa\n",
+				 region->label, &region->base, &region->size);
+	mutex_unlock(&kexec_mutex);
+	return len;
+}
+
 size_t crash_get_memory_size(void)
 {
 	size_t size = 0;
@@ -125,6 +125,14 @@ static ssize_t kexec_crash_size_store(struct kobject *kobj,
 }
 KERNEL_ATTR_RW(kexec_crash_size);
 
+static ssize_t kexec_preserved_regions_show(struct kobject *kobj,
+					    struct kobj_attribute *attr,
+					    char *buf)
+{
+	return kexec_preserved_show(buf);
+}
+KERNEL_ATTR_RO(kexec_preserved_regions);
+
 static ssize_t vmcoreinfo_show(struct kobject *kobj,
 			       struct kobj_attribute *attr, char *buf)
 {
@@ -200,6 +208,7 @@ static struct attribute * kernel_attrs[] = {
 	&kexec_loaded_attr.attr,
 	&kexec_crash_loaded_attr.attr,
 	&kexec_crash_size_attr.attr,
+	&kexec_preserved_regions_attr.attr,
 	&vmcoreinfo_attr.attr,
 #endif
 	&rcu_expedited_attr.attr,
@@ -59,6 +59,8 @@
 #include <linux/jump_label.h>
 #include <linux/pfn.h>
 #include <linux/bsearch.h>
+#include <linux/hashtable.h>
+#include <linux/jhash.h>
 #include <uapi/linux/module.h>
 #include "module-internal.h"
 
@@ -274,6 +276,25 @@ extern const unsigned long __start___kcrctab_unused_gpl[];
 #define symversion(base, idx) ((base != NULL) ? ((base) + (idx)) : NULL)
 #endif
 
+static const struct symsearch vmlinux_syms[] = {
+	{ __start___ksymtab, __stop___ksymtab, __start___kcrctab,
+	  NOT_GPL_ONLY, false },
+	{ __start___ksymtab_gpl, __stop___ksymtab_gpl,
+	  __start___kcrctab_gpl,
+	  GPL_ONLY, false },
+	{ __start___ksymtab_gpl_future, __stop___ksymtab_gpl_future,
+	  __start___kcrctab_gpl_future,
+	  WILL_BE_GPL_ONLY, false },
+#ifdef CONFIG_UNUSED_SYMBOLS
+	{ __start___ksymtab_unused, __stop___ksymtab_unused,
+	  __start___kcrctab_unused,
+	  NOT_GPL_ONLY, true },
+	{ __start___ksymtab_unused_gpl, __stop___ksymtab_unused_gpl,
+	  __start___kcrctab_unused_gpl,
+	  GPL_ONLY, true },
+#endif
+};
+
 static bool each_symbol_in_section(const struct symsearch *arr,
 				   unsigned int arrsize,
 				   struct module *owner,
@@ -299,26 +320,9 @@ bool each_symbol_section(bool (*fn)(const struct symsearch *arr,
 			 void *data)
 {
 	struct module *mod;
-	static const struct symsearch arr[] = {
-		{ __start___ksymtab, __stop___ksymtab, __start___kcrctab,
-		  NOT_GPL_ONLY, false },
-		{ __start___ksymtab_gpl, __stop___ksymtab_gpl,
-		  __start___kcrctab_gpl,
-		  GPL_ONLY, false },
-		{ __start___ksymtab_gpl_future, __stop___ksymtab_gpl_future,
-		  __start___kcrctab_gpl_future,
-		  WILL_BE_GPL_ONLY, false },
-#ifdef CONFIG_UNUSED_SYMBOLS
-		{ __start___ksymtab_unused, __stop___ksymtab_unused,
-		  __start___kcrctab_unused,
-		  NOT_GPL_ONLY, true },
-		{ __start___ksymtab_unused_gpl, __stop___ksymtab_unused_gpl,
-		  __start___kcrctab_unused_gpl,
-		  GPL_ONLY, true },
-#endif
-	};
 
-	if (each_symbol_in_section(arr, ARRAY_SIZE(arr), NULL, fn, data))
+	if (each_symbol_in_section(vmlinux_syms, ARRAY_SIZE(vmlinux_syms),
+				   NULL, fn, data))
 		return true;
 
 	list_for_each_entry_rcu(mod, &modules, list) {
@@ -424,6 +428,196 @@ static bool find_symbol_in_section(const struct symsearch *syms,
 	return false;
 }
 
+#ifdef CONFIG_MODULE_SYMBOL_HASH
+/*
+ * Every exported symbol of the kernel and of the formed modules, hashed by
+ * name, so that resolving a module's undefined symbols doesn't have to
+ * search every export table in turn.  Symbol names are unique across all
+ * of them (see verify_export_symbols()), so the first match is the only
+ * one.  Updated under module_mutex, walked with preempt disabled.
+ */
+#define KSYM_HASH_BITS	12
+static DEFINE_HASHTABLE(ksym_hash, KSYM_HASH_BITS);
+static bool ksym_hash_populated;
+
+struct ksym_table {
+	struct symsearch syms;
+	struct module *owner;
+};
+
+struct ksym_entry {
+	struct hlist_node node;
+	const struct kernel_symbol *sym;
+	const struct ksym_table *table;
+};
+
+/* The index of one module's exports, freed with the module */
+struct ksym_index {
+	struct ksym_table tables[ARRAY_SIZE(vmlinux_syms)];
+	struct ksym_entry entries[];
+};
+
+static inline u32 ksym_hashfn(const char *name)
+{
+	return jhash(name, strlen(name), 0);
+}
+
+static inline bool ksym_hash_ready(void)
+{
+	return smp_load_acquire(&ksym_hash_populated);
+}
+
+/* Hash the symbols of @table into @e, returns the number of entries used */
+static unsigned int ksym_hash_add(const struct ksym_table *table,
+				  struct ksym_entry *e)
+{
+	const struct kernel_symbol *sym;
+
+	for (sym = table->syms.start; sym < table->syms.stop; sym++, e++) {
+		e->sym = sym;
+		e->table = table;
+		hash_add_rcu(ksym_hash, &e->node, ksym_hashfn(sym->name));
+	}
+	return table->syms.stop - table->syms.start;
+}
+
+static bool find_symbol_hashed(struct find_symbol_arg *fsa)
+{
+	struct ksym_entry *e;
+
+	hash_for_each_possible_rcu(ksym_hash, e, node, ksym_hashfn(fsa->name))
+		if (strcmp(e->sym->name, fsa->name) == 0)
+			return check_symbol(&e->table->syms, e->table->owner,
+					    e->sym - e->table->syms.start, fsa);
+	return false;
+}
+
+/* Index the exports of a module about to become visible: module_mutex */
+static int ksym_index_add_module(struct module *mod)
+{
+	struct ksym_index *index;
+	struct ksym_entry *e;
+	unsigned int i, count;
+	const struct symsearch arr[] = {
+		{ mod->syms, mod->syms + mod->num_syms, mod->crcs,
+		  NOT_GPL_ONLY, false },
+		{ mod->gpl_syms, mod->gpl_syms + mod->num_gpl_syms,
+		  mod->gpl_crcs,
+		  GPL_ONLY, false },
+		{ mod->gpl_future_syms,
+		  mod->gpl_future_syms + mod->num_gpl_future_syms,
+		  mod->gpl_future_crcs,
+		  WILL_BE_GPL_ONLY, false },
+#ifdef CONFIG_UNUSED_SYMBOLS
+		{ mod->unused_syms,
+		  mod->unused_syms + mod->num_unused_syms,
+		  mod->unused_crcs,
+		  NOT_GPL_ONLY, true },
+		{ mod->unused_gpl_syms,
+		  mod->unused_gpl_syms + mod->num_unused_gpl_syms,
+		  mod->unused_gpl_crcs,
+		  GPL_ONLY, true },
+#endif
+	};
+
+	for (i = 0, count = 0; i < ARRAY_SIZE(arr); i++)
+		count += arr[i].stop - arr[i].start;
+	if (!count)
+		return 0;
+
+	index = kmalloc(sizeof(*index) + count * sizeof(*e), GFP_KERNEL);
+	if (!index)
+		return -ENOMEM;
+
+	for (i = 0, e = index->entries; i < ARRAY_SIZE(arr); i++) {
+		index->tables[i].syms = arr[i];
+		index->tables[i].owner = mod;
+		e += ksym_hash_add(&index->tables[i], e);
+	}
+	mod->ksym_index = index;
+	return 0;
+}
+
+/*
+ * Unhash a module's exports: module_mutex.  The index itself must only be
+ * freed after an RCU grace period.
+ */
+static void ksym_index_del_module(struct module *mod)
+{
+	struct ksym_index *index = mod->ksym_index;
+	struct ksym_entry *e;
+	unsigned int i;
+
+	if (!index)
+		return;
+
+	for (i = 0, e = index->entries; i < ARRAY_SIZE(index->tables); i++) {
+		const struct symsearch *syms = &index->tables[i].syms;
+		unsigned int n;
+
+		for (n = syms->stop - syms->start; n; n--, e++)
+			hash_del_rcu(&e->node);
+	}
+}
+
+static void ksym_index_free_module(struct module *mod)
+{
+	kfree(mod->ksym_index);
+	mod->ksym_index = NULL;
+}
+
+/*
+ * Modules can't be loaded this early, but __symbol_get() can be called
+ * before we get here, so find_symbol() falls back to searching the tables
+ * until the kernel's own exports are in.
+ */
+static int __init ksym_hash_init(void)
+{
+	static struct ksym_table tables[ARRAY_SIZE(vmlinux_syms)];
+	struct ksym_entry *e;
+	unsigned int i, count;
+
+	for (i = 0, count = 0; i < ARRAY_SIZE(vmlinux_syms); i++)
+		count += vmlinux_syms[i].stop - vmlinux_syms[i].start;
+
+	e = kmalloc_array(count, sizeof(*e), GFP_KERNEL);
+	if (!e) {
+		pr_warn("no memory for the exported symbol hash\n");
+		return -ENOMEM;
+	}
+
+	mutex_lock(&module_mutex);
+	for (i = 0; i < ARRAY_SIZE(vmlinux_syms); i++) {
+		tables[i].syms = vmlinux_syms[i];
+		tables[i].owner = NULL;
+		e += ksym_hash_add(&tables[i], e);
+	}
+	smp_store_release(&ksym_hash_populated, true);
+	mutex_unlock(&module_mutex);
+
+	return 0;
+}
+core_initcall(ksym_hash_init);
+#else
+static inline bool ksym_hash_ready(void)
+{
+	return false;
+}
+
+static inline bool find_symbol_hashed(struct find_symbol_arg *fsa)
+{
+	return false;
+}
+
+static inline int ksym_index_add_module(struct module *mod)
+{
+	return 0;
+}
+
+static inline void ksym_index_del_module(struct module *mod) { }
+static inline void ksym_index_free_module(struct module *mod) { }
+#endif /* CONFIG_MODULE_SYMBOL_HASH */
+
 /* Find a symbol and return it, along with, (optional) crc and
  * (optional) module which owns it.  Needs preempt disabled or module_mutex. */
 const struct kernel_symbol *find_symbol(const char *name,
@@ -438,7 +632,8 @@ const struct kernel_symbol *find_symbol(const char *name,
 	fsa.gplok = gplok;
 	fsa.warn = warn;
 
-	if (each_symbol_section(find_symbol_in_section, &fsa)) {
+	if (ksym_hash_ready() ? find_symbol_hashed(&fsa) :
+	    each_symbol_section(find_symbol_in_section, &fsa)) {
 		if (owner)
 			*owner = fsa.owner;
 		if (crc)
@@ -1225,6 +1420,25 @@ static const struct kernel_symbol *resolve_symbol(struct module *mod,
 	const unsigned long *crc;
 	int err;
 
+	bool gplok = !(mod->taints & (1 << TAINT_PROPRIETARY_MODULE));
+
+	/*
+	 * Most symbols come from the kernel itself, which needs no reference
+	 * and can't go away, so look there without taking module_mutex:
+	 * modules loaded in parallel would otherwise serialize on every one
+	 * of their symbols.
+	 */
+	preempt_disable();
+	sym = find_symbol(name, &owner, &crc, gplok, true);
+	preempt_enable();
+	if (sym && !owner) {
+		if (!check_version(info->sechdrs, info->index.vers, name, mod,
+				   crc, owner))
+			sym = ERR_PTR(-EINVAL);
+		strncpy(ownername, module_name(owner), MODULE_NAME_LEN);
+		return sym;
+	}
+
 	/*
 	 * The module_mutex should not be a heavily contended lock;
 	 * if we get the occasional sleep here, we'll go an extra iteration
@@ -1232,8 +1446,7 @@ static const struct kernel_symbol *resolve_symbol(struct module *mod,
 	 */
 	sched_annotate_sleep();
 	mutex_lock(&module_mutex);
-	sym = find_symbol(name, &owner, &crc,
-			  !(mod->taints & (1 << TAINT_PROPRIETARY_MODULE)), true);
+	sym = find_symbol(name, &owner, &crc, gplok, !sym);
 	if (!sym)
 		goto unlock;
 
@@ -1834,6 +2047,7 @@ static void free_module(struct module *mod)
 	 * that noone uses it while it's being deconstructed. */
 	mutex_lock(&module_mutex);
 	mod->state = MODULE_STATE_UNFORMED;
+	ksym_index_del_module(mod);
 	mutex_unlock(&module_mutex);
 
 	/* Remove dynamic debug info */
@@ -1858,6 +2072,8 @@ static void free_module(struct module *mod)
 	synchronize_rcu();
 	mutex_unlock(&module_mutex);
 
+	ksym_index_free_module(mod);
+
 	/* This may be NULL, but that's OK */
 	unset_module_init_ro_nx(mod);
 	module_arch_freeing_init(mod);
@@ -3208,6 +3424,10 @@ static int complete_formation(struct module *mod, struct load_info *info)
 	if (err < 0)
 		goto out;
 
+	err = ksym_index_add_module(mod);
+	if (err < 0)
+		goto out;
+
 	/* This relies on module_mutex for list integrity. */
 	module_bug_finalize(info->hdr, info->sechdrs, mod);
 
@@ -3368,6 +3588,7 @@ static int load_module(struct load_info *info, const char __user *uargs,
 	/* module_bug_cleanup needs module_mutex protection */
 	mutex_lock(&module_mutex);
 	module_bug_cleanup(mod);
+	ksym_index_del_module(mod);
 	mutex_unlock(&module_mutex);
 
 	blocking_notifier_call_chain(&module_notify_list,
@@ -3395,6 +3616,7 @@ static int load_module(struct load_info *info, const char __user *uargs,
 	/* Wait for RCU synchronizing before releasing mod->list. */
 	synchronize_rcu();
 	mutex_unlock(&module_mutex);
+	ksym_index_free_module(mod);
  free_module:
 	/* Free lock-classes; relies on the preceding sync_rcu() */
 	lockdep_free_key_range(mod->module_core, mod->core_size);
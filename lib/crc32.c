@@ -181,22 +181,27 @@ static inline u32 __pure crc32_le_generic(u32 crc, unsigned char const *p,
 	return crc;
 }
 
+/*
+ * crc32_le() and __crc32c_le() are weak so that architectures can provide
+ * accelerated versions; those can fall back to the table driven code
+ * through crc32_le_base() and __crc32c_le_base().
+ */
 #if CRC_LE_BITS == 1
-u32 __pure crc32_le(u32 crc, unsigned char const *p, size_t len)
+u32 __pure __weak crc32_le(u32 crc, unsigned char const *p, size_t len)
 {
 	return crc32_le_generic(crc, p, len, NULL, CRCPOLY_LE);
 }
-u32 __pure __crc32c_le(u32 crc, unsigned char const *p, size_t len)
+u32 __pure __weak __crc32c_le(u32 crc, unsigned char const *p, size_t len)
 {
 	return crc32_le_generic(crc, p, len, NULL, CRC32C_POLY_LE);
 }
 #else
-u32 __pure crc32_le(u32 crc, unsigned char const *p, size_t len)
+u32 __pure __weak crc32_le(u32 crc, unsigned char const *p, size_t len)
 {
 	return crc32_le_generic(crc, p, len,
 			(const u32 (*)[256])crc32table_le, CRCPOLY_LE);
 }
-u32 __pure __crc32c_le(u32 crc, unsigned char const *p, size_t len)
+u32 __pure __weak __crc32c_le(u32 crc, unsigned char const *p, size_t len)
 {
 	return crc32_le_generic(crc, p, len,
 			(const u32 (*)[256])crc32ctable_le, CRC32C_POLY_LE);
@@ -205,6 +210,13 @@ u32 __pure __crc32c_le(u32 crc, unsigned char const *p, size_t len)
 EXPORT_SYMBOL(crc32_le);
 EXPORT_SYMBOL(__crc32c_le);
 
+u32 __pure crc32_le_base(u32, unsigned char const *, size_t)
+	__alias(crc32_le);
+u32 __pure __crc32c_le_base(u32, unsigned char const *, size_t)
+	__alias(__crc32c_le);
+EXPORT_SYMBOL(crc32_le_base);
+EXPORT_SYMBOL(__crc32c_le_base);
+
 /*
  * This multiplies the polynomials x and y modulo the given modulus.
  * This follows the "little-endian" CRC convention that the lsbit
@@ -973,6 +985,7 @@ static struct crc_test {
 };
 
 #include <linux/time.h>
+#include <linux/math64.h>
 
 static int __init crc32c_test(void)
 {
@@ -1154,6 +1167,84 @@ static int __init crc32_combine_test(void)
 	return 0;
 }
 
+/*
+ * Check crc32_le() and __crc32c_le() against the table driven code for
+ * lengths and alignments on both sides of the thresholds at which
+ * accelerated versions typically switch strategy.
+ */
+static int __init crc32_base_test(void)
+{
+	int errors = 0, runs = 0;
+	size_t len, off;
+
+	for (len = 0; len + 16 <= sizeof(test_buf); len += len < 320 ? 1 : 61) {
+		for (off = 0; off < 16; off += 5) {
+			if (crc32_le(len, test_buf + off, len) !=
+			    crc32_le_base(len, test_buf + off, len))
+				errors++;
+			if (__crc32c_le(~len, test_buf + off, len) !=
+			    __crc32c_le_base(~len, test_buf + off, len))
+				errors++;
+			runs += 2;
+		}
+		cond_resched();
+	}
+
+	if (errors)
+		pr_warn("crc32_base: %d/%d self tests failed\n", errors, runs);
+	else
+		pr_info("crc32_base: %d self tests passed\n", runs);
+
+	return 0;
+}
+
+static u64 __init crc32_bench_one(u32 (*fn)(u32, unsigned char const *,
+					    size_t), size_t len)
+{
+	/* keep static to prevent the calls from being optimized away */
+	static u32 crc;
+	struct timespec start, stop;
+	size_t bytes = 0;
+	u64 nsec;
+
+	crc ^= fn(crc, test_buf, len);
+
+	getnstimeofday(&start);
+	while (bytes < (1 << 20)) {
+		crc = fn(crc, test_buf, len);
+		bytes += len;
+	}
+	getnstimeofday(&stop);
+
+	nsec = stop.tv_nsec - start.tv_nsec +
+		1000000000ULL * (stop.tv_sec - start.tv_sec);
+
+	/* MB/s */
+	return div64_u64((u64)bytes * 1000, nsec ?: 1);
+}
+
+/*
+ * Throughput of crc32_le() and __crc32c_le() compared to the table driven
+ * code, for a few block sizes.
+ */
+static int __init crc32_bench(void)
+{
+	static const size_t sizes[] __initconst = { 64, 256, 1024, 4096 };
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		pr_info("crc32: %4zu byte blocks: %llu MB/s (table %llu MB/s)\n",
+			sizes[i], crc32_bench_one(crc32_le, sizes[i]),
+			crc32_bench_one(crc32_le_base, sizes[i]));
+		pr_info("crc32c: %4zu byte blocks: %llu MB/s (table %llu MB/s)\n",
+			sizes[i], crc32_bench_one(__crc32c_le, sizes[i]),
+			crc32_bench_one(__crc32c_le_base, sizes[i]));
+		cond_resched();
+	}
+
+	return 0;
+}
+
 static int __init crc32test_init(void)
 {
 	crc32_test();
@@ -1162,6 +1253,9 @@ static int __init crc32test_init(void)
 	crc32_combine_test();
 	crc32c_combine_test();
 
+	crc32_base_test();
+	crc32_bench();
+
 	return 0;
 }
 
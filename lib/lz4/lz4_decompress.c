@@ -92,9 +92,7 @@ static int lz4_uncompress(const char *source, char *dest, int osize)
 			ip += length;
 			break; /* EOF */
 		}
-		LZ4_WILDCOPY(ip, op, cpy);
-		ip -= (op - cpy);
-		op = cpy;
+		LZ4_COPYLITERALS(ip, op, cpy);
 
 		/* get offset */
 		LZ4_READ_LITTLEENDIAN_16(ref, cpy, ip);
@@ -214,9 +212,7 @@ static int lz4_uncompress_unknownoutputsize(const char *source, char *dest,
 			op += length;
 			break;/* Necessarily EOF, due to parsing restrictions */
 		}
-		LZ4_WILDCOPY(ip, op, cpy);
-		ip -= (op - cpy);
-		op = cpy;
+		LZ4_COPYLITERALS(ip, op, cpy);
 
 		/* get offset */
 		LZ4_READ_LITTLEENDIAN_16(ref, cpy, ip);
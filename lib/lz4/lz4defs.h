@@ -148,6 +148,36 @@ typedef struct _U64_S { u64 v; } U64_S;
 		LZ4_COPYPACKET(s, d);	\
 	} while (d < e)
 
+/*
+ * Copy the literals from s to d up to e, leaving both pointers at the end
+ * of the run. On 32-bit architectures a packet is only two word copies,
+ * while the arch memcpy() moves whole cache lines with load/store multiple,
+ * so long runs (typical of poorly compressible data) go through memcpy().
+ */
+#if LZ4_ARCH64
+#define LZ4_COPYLITERALS(s, d, e)	\
+	do {				\
+		LZ4_WILDCOPY(s, d, e);	\
+		s -= (d - e);		\
+		d = e;			\
+	} while (0)
+#else
+#define LZ4_MEMCPY_MIN	64
+
+#define LZ4_COPYLITERALS(s, d, e)			\
+	do {						\
+		if ((e) - (d) >= LZ4_MEMCPY_MIN) {	\
+			memcpy(d, s, (e) - (d));	\
+			s += (e) - (d);			\
+			d = e;				\
+		} else {				\
+			LZ4_WILDCOPY(s, d, e);		\
+			s -= (d - e);			\
+			d = e;				\
+		}					\
+	} while (0)
+#endif
+
 #define LZ4_BLINDCOPY(s, d, l)	\
 	do {	\
 		u8 *e = (d) + l;	\
@@ -81,7 +81,7 @@ int lzo1x_decompress_safe(const unsigned char *in, size_t in_len,
 				}
 				t += 3;
 copy_literal_run:
-#if defined(CONFIG_HAVE_EFFICIENT_UNALIGNED_ACCESS)
+#if defined(LZO_FAST_UNALIGNED_COPY)
 				if (likely(HAVE_IP(t + 15) && HAVE_OP(t + 15))) {
 					const unsigned char *ie = ip + t;
 					unsigned char *oe = op + t;
@@ -182,7 +182,7 @@ copy_literal_run:
 			m_pos -= 0x4000;
 		}
 		TEST_LB(m_pos);
-#if defined(CONFIG_HAVE_EFFICIENT_UNALIGNED_ACCESS)
+#if defined(LZO_FAST_UNALIGNED_COPY)
 		if (op - m_pos >= 8) {
 			unsigned char *oe = op + t;
 			if (likely(HAVE_OP(t + 15))) {
@@ -208,6 +208,14 @@ copy_literal_run:
 					*op++ = *m_pos++;
 				} while (op < oe);
 			}
+		} else if (op - m_pos >= 4 && likely(HAVE_OP(t + 3))) {
+			unsigned char *oe = op + t;
+			do {
+				COPY4(op, m_pos);
+				op += 4;
+				m_pos += 4;
+			} while (op < oe);
+			op = oe;
 		} else
 #endif
 		{
@@ -224,7 +232,7 @@ copy_literal_run:
 match_next:
 		state = next;
 		t = next;
-#if defined(CONFIG_HAVE_EFFICIENT_UNALIGNED_ACCESS)
+#if defined(LZO_FAST_UNALIGNED_COPY)
 		if (likely(HAVE_IP(6) && HAVE_OP(4))) {
 			COPY4(op, ip);
 			op += t;
@@ -22,6 +22,20 @@
 		COPY4(dst, src); COPY4((dst) + 4, (src) + 4)
 #endif
 
+/*
+ * The decompressor copies literals and matches a word at a time when
+ * unaligned word accesses are fast. ARMv6 and later handle unaligned
+ * ldr/str in hardware and get_unaligned()/put_unaligned() compile to
+ * exactly those, even though the architecture does not select
+ * HAVE_EFFICIENT_UNALIGNED_ACCESS because ldrd/ldm still trap. The boot
+ * decompressor (STATIC) is left alone as it may run with the MMU off.
+ */
+#if defined(CONFIG_HAVE_EFFICIENT_UNALIGNED_ACCESS) || \
+	(defined(CONFIG_ARM) && __LINUX_ARM_ARCH__ >= 6 && \
+	 defined(CONFIG_MMU) && !defined(STATIC))
+#define LZO_FAST_UNALIGNED_COPY	1
+#endif
+
 #if defined(__BIG_ENDIAN) && defined(__LITTLE_ENDIAN)
 #error "conflicting endian definitions"
 #elif defined(__x86_64__)
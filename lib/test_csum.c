@@ -0,0 +1,207 @@
+/*
+ * Correctness and speed test for the architecture's csum_partial()
+ * and copy-and-checksum routines.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * Every routine is checked against a byte at a time reference at random
+ * offsets and lengths, then timed over a range of packet sizes.  Where the
+ * architecture picks an implementation by length (e.g. the ARM NEON code,
+ * see csum.neon_min_len) the module can be loaded once with each setting
+ * to compare them.
+ */
+
+#define pr_fmt(fmt) KBUILD_MODNAME ": " fmt
+
+#include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/mman.h>
+#include <linux/module.h>
+#include <linux/random.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <net/checksum.h>
+#include <asm/unaligned.h>
+
+#define TEST_BUF_SIZE	(64 * 1024 + 64)
+
+static unsigned int iterations = 1000;
+module_param(iterations, uint, 0444);
+MODULE_PARM_DESC(iterations, "Number of passes per packet size (default 1000)");
+
+static unsigned int rounds = 10000;
+module_param(rounds, uint, 0444);
+MODULE_PARM_DESC(rounds, "Number of random correctness checks (default 10000)");
+
+static const unsigned int test_sizes[] = {
+	64, 128, 256, 512, 1024, 1500, 4096, 16384, 65536,
+};
+
+/* Ones' complement sum of 16-bit words in memory order, folded */
+static u16 ref_csum(const u8 *p, int len)
+{
+	u32 sum = 0;
+
+	for (; len > 1; p += 2, len -= 2)
+		sum += get_unaligned((const u16 *)p);
+	if (len) {
+#ifdef __BIG_ENDIAN
+		sum += *p << 8;
+#else
+		sum += *p;
+#endif
+	}
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+
+	return ~sum & 0xffff;
+}
+
+static int test_correctness(u8 *src, u8 *dst, void __user *usrc)
+{
+	unsigned int i, failed = 0;
+
+	for (i = 0; i < rounds; i++) {
+		unsigned int off = prandom_u32() & 63;
+		unsigned int len = prandom_u32() % (TEST_BUF_SIZE - 64);
+		u16 want, got;
+		int err = 0;
+
+		/* Check the short end as thoroughly as the long one */
+		if (i & 1)
+			len &= 2047;
+		want = ref_csum(src + off, len);
+
+		got = (__force u16)csum_fold(csum_partial(src + off, len, 0));
+		if (got != want) {
+			pr_err("csum_partial(+%u, %u): %04x, expected %04x\n",
+			       off, len, got, want);
+			failed++;
+		}
+
+		memset(dst, 0, len);
+		got = (__force u16)csum_fold(
+			csum_partial_copy_nocheck(src + off, dst, len, 0));
+		if (got != want || memcmp(dst, src + off, len)) {
+			pr_err("csum_partial_copy_nocheck(+%u, %u): %04x, expected %04x\n",
+			       off, len, got, want);
+			failed++;
+		}
+
+		memset(dst, 0, len);
+		got = (__force u16)csum_fold(
+			csum_and_copy_from_user(usrc + off, dst, len, 0, &err));
+		if (err || got != want || memcmp(dst, src + off, len)) {
+			pr_err("csum_and_copy_from_user(+%u, %u): %04x, expected %04x, err %d\n",
+			       off, len, got, want, err);
+			failed++;
+		}
+
+		if (failed > 10)
+			break;
+		if (!(i & 255))
+			cond_resched();
+	}
+
+	return failed ? -EINVAL : 0;
+}
+
+/*
+ * Print one line per packet size with the cost of a single call of each
+ * routine, which is what a length cut-over such as neon_min_len is tuned
+ * against.
+ */
+static void test_speed(u8 *src, u8 *dst, void __user *usrc)
+{
+	u64 partial, copy, from_user;
+	unsigned int i, n, len;
+	ktime_t start;
+	__wsum sum;
+	int err;
+
+	if (!iterations)
+		return;
+
+	pr_info("  size  csum_partial  copy_nocheck  copy_from_user (ns per call)\n");
+
+	for (i = 0; i < ARRAY_SIZE(test_sizes); i++) {
+		len = test_sizes[i];
+
+		sum = 0;
+		start = ktime_get();
+		for (n = 0; n < iterations; n++)
+			sum = csum_partial(src, len, sum);
+		partial = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+		start = ktime_get();
+		for (n = 0; n < iterations; n++)
+			sum = csum_partial_copy_nocheck(src, dst, len, sum);
+		copy = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+		err = 0;
+		start = ktime_get();
+		for (n = 0; n < iterations; n++)
+			sum = csum_and_copy_from_user(usrc, dst, len, sum, &err);
+		from_user = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+		pr_info("%6u  %12llu  %12llu  %14llu\n", len,
+			div_u64(partial, iterations), div_u64(copy, iterations),
+			div_u64(from_user, iterations));
+
+		cond_resched();
+	}
+}
+
+static int __init test_csum_init(void)
+{
+	unsigned long user_addr;
+	u8 *src, *dst;
+	int ret = -ENOMEM;
+
+	src = kmalloc(TEST_BUF_SIZE, GFP_KERNEL);
+	dst = kmalloc(TEST_BUF_SIZE, GFP_KERNEL);
+	if (!src || !dst)
+		goto out_free;
+
+	user_addr = vm_mmap(NULL, 0, PAGE_ALIGN(TEST_BUF_SIZE),
+			    PROT_READ | PROT_WRITE,
+			    MAP_ANONYMOUS | MAP_PRIVATE, 0);
+	if (user_addr >= (unsigned long)(TASK_SIZE)) {
+		pr_warn("Failed to allocate user memory\n");
+		goto out_free;
+	}
+
+	prandom_bytes(src, TEST_BUF_SIZE);
+	if (copy_to_user((void __user *)user_addr, src, TEST_BUF_SIZE)) {
+		ret = -EFAULT;
+		goto out_unmap;
+	}
+
+	ret = test_correctness(src, dst, (void __user *)user_addr);
+	if (ret)
+		pr_err("checksum mismatch, not measuring speed\n");
+	else
+		test_speed(src, dst, (void __user *)user_addr);
+
+out_unmap:
+	vm_munmap(user_addr, PAGE_ALIGN(TEST_BUF_SIZE));
+out_free:
+	kfree(dst);
+	kfree(src);
+
+	return ret;
+}
+
+static void __exit test_csum_exit(void)
+{
+}
+
+module_init(test_csum_init);
+module_exit(test_csum_exit);
+
+MODULE_DESCRIPTION("Checksum correctness and speed test");
+MODULE_LICENSE("GPL");
@@ -0,0 +1,432 @@
+/*
+ * Decompression speed test for the in-kernel LZO, LZ4, zlib and XZ
+ * decoders.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * The sample data is generated to compress about as well as a typical
+ * filesystem image: a mix of text-like runs, zeroes and random bytes,
+ * the same on every load so that runs can be compared.  It
+ * is compressed block by block with each algorithm, every block is checked
+ * to round trip, and then all blocks are decompressed 'iterations' times
+ * to measure the decoder.  There is no XZ compressor in the kernel, so XZ
+ * is only measured when a compressed file is given with the 'xz_file'
+ * parameter, which is fetched with request_firmware().
+ */
+
+#define pr_fmt(fmt) KBUILD_MODNAME ": " fmt
+
+#include <linux/device.h>
+#include <linux/firmware.h>
+#include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/lz4.h>
+#include <linux/lzo.h>
+#include <linux/math64.h>
+#include <linux/module.h>
+#include <linux/random.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/xz.h>
+#include <linux/zlib.h>
+
+static unsigned int size = 256 * 1024;
+module_param(size, uint, 0444);
+MODULE_PARM_DESC(size, "Bytes of sample data to compress (default 256K)");
+
+static unsigned int iterations = 20;
+module_param(iterations, uint, 0444);
+MODULE_PARM_DESC(iterations, "Number of decompression passes (default 20)");
+
+static unsigned int block_size = PAGE_SIZE;
+module_param(block_size, uint, 0444);
+MODULE_PARM_DESC(block_size, "Size of each compressed block (default PAGE_SIZE)");
+
+static char *xz_file;
+module_param(xz_file, charp, 0444);
+MODULE_PARM_DESC(xz_file, "Firmware file holding a .xz stream to decode");
+
+struct decomp_block {
+	void *data;
+	size_t len;
+};
+
+struct decomp_test {
+	const char *name;
+	size_t (*bound)(size_t len);
+	int (*init)(void);
+	void (*exit)(void);
+	int (*compress)(const u8 *src, size_t len, u8 *dst, size_t *dst_len);
+	int (*decompress)(const u8 *src, size_t len, u8 *dst, size_t *dst_len);
+};
+
+static void *wrkmem;
+
+static size_t lzo_bound(size_t len)
+{
+	return lzo1x_worst_compress(len);
+}
+
+static int lzo_init(void)
+{
+	wrkmem = vmalloc(LZO1X_1_MEM_COMPRESS);
+	return wrkmem ? 0 : -ENOMEM;
+}
+
+static void wrkmem_free(void)
+{
+	vfree(wrkmem);
+	wrkmem = NULL;
+}
+
+static int lzo_compress(const u8 *src, size_t len, u8 *dst, size_t *dst_len)
+{
+	return lzo1x_1_compress(src, len, dst, dst_len, wrkmem);
+}
+
+static int lzo_decompress(const u8 *src, size_t len, u8 *dst, size_t *dst_len)
+{
+	return lzo1x_decompress_safe(src, len, dst, dst_len);
+}
+
+static int lz4_init(void)
+{
+	wrkmem = vmalloc(LZ4_MEM_COMPRESS);
+	return wrkmem ? 0 : -ENOMEM;
+}
+
+static int lz4_compress_block(const u8 *src, size_t len, u8 *dst,
+			      size_t *dst_len)
+{
+	return lz4_compress(src, len, dst, dst_len, wrkmem);
+}
+
+static int lz4_decompress_block(const u8 *src, size_t len, u8 *dst,
+				size_t *dst_len)
+{
+	return lz4_decompress_unknownoutputsize(src, len, dst, dst_len);
+}
+
+/* Raw deflate, so that only the inflate loop itself is measured */
+static z_stream zstrm;
+
+static size_t zlib_bound(size_t len)
+{
+	return len + (len >> 12) + (len >> 14) + 64;
+}
+
+static int zlib_init(void)
+{
+	size_t ws = max(zlib_deflate_workspacesize(-MAX_WBITS, MAX_MEM_LEVEL),
+			zlib_inflate_workspacesize());
+
+	zstrm.workspace = vmalloc(ws);
+	return zstrm.workspace ? 0 : -ENOMEM;
+}
+
+static void zlib_exit(void)
+{
+	vfree(zstrm.workspace);
+	zstrm.workspace = NULL;
+}
+
+static int zlib_compress(const u8 *src, size_t len, u8 *dst, size_t *dst_len)
+{
+	int ret;
+
+	if (zlib_deflateInit2(&zstrm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+			      -MAX_WBITS, DEF_MEM_LEVEL,
+			      Z_DEFAULT_STRATEGY) != Z_OK)
+		return -EINVAL;
+
+	zstrm.next_in = src;
+	zstrm.avail_in = len;
+	zstrm.next_out = dst;
+	zstrm.avail_out = *dst_len;
+	ret = zlib_deflate(&zstrm, Z_FINISH);
+	zlib_deflateEnd(&zstrm);
+	if (ret != Z_STREAM_END)
+		return -EINVAL;
+
+	*dst_len = zstrm.total_out;
+	return 0;
+}
+
+static int zlib_decompress(const u8 *src, size_t len, u8 *dst,
+			   size_t *dst_len)
+{
+	int ret;
+
+	if (zlib_inflateInit2(&zstrm, -MAX_WBITS) != Z_OK)
+		return -EINVAL;
+
+	zstrm.next_in = src;
+	zstrm.avail_in = len;
+	zstrm.next_out = dst;
+	zstrm.avail_out = *dst_len;
+	ret = zlib_inflate(&zstrm, Z_FINISH);
+	zlib_inflateEnd(&zstrm);
+	if (ret != Z_STREAM_END)
+		return -EINVAL;
+
+	*dst_len = zstrm.total_out;
+	return 0;
+}
+
+static const struct decomp_test decomp_tests[] = {
+	{
+		.name		= "lzo",
+		.bound		= lzo_bound,
+		.init		= lzo_init,
+		.exit		= wrkmem_free,
+		.compress	= lzo_compress,
+		.decompress	= lzo_decompress,
+	}, {
+		.name		= "lz4",
+		.bound		= lz4_compressbound,
+		.init		= lz4_init,
+		.exit		= wrkmem_free,
+		.compress	= lz4_compress_block,
+		.decompress	= lz4_decompress_block,
+	}, {
+		.name		= "zlib",
+		.bound		= zlib_bound,
+		.init		= zlib_init,
+		.exit		= zlib_exit,
+		.compress	= zlib_compress,
+		.decompress	= zlib_decompress,
+	},
+};
+
+/*
+ * Block based users such as zram or squashfs care about the cost of one
+ * decompression call, so report that next to the compression ratio.
+ */
+static void report(const char *name, size_t packed, size_t unpacked, u64 ns,
+		   unsigned int calls)
+{
+	pr_info("%-4s: %zu -> %zu bytes (%zu%%), %llu ns per call\n", name,
+		unpacked, packed, unpacked ? packed * 100 / unpacked : 0,
+		div_u64(ns, max(calls, 1U)));
+}
+
+static int run_test(const struct decomp_test *t, const u8 *src, size_t len,
+		    u8 *out)
+{
+	unsigned int nblocks = DIV_ROUND_UP(len, block_size);
+	struct decomp_block *blocks;
+	size_t total = 0;
+	unsigned int i, n;
+	ktime_t start;
+	int err;
+
+	err = t->init();
+	if (err)
+		return err;
+
+	blocks = kcalloc(nblocks, sizeof(*blocks), GFP_KERNEL);
+	if (!blocks) {
+		err = -ENOMEM;
+		goto out_exit;
+	}
+
+	for (i = 0; i < nblocks; i++) {
+		size_t blen = min_t(size_t, block_size, len - i * block_size);
+		size_t dlen = block_size;
+
+		blocks[i].len = t->bound(block_size);
+		blocks[i].data = kmalloc(blocks[i].len, GFP_KERNEL);
+		if (!blocks[i].data) {
+			err = -ENOMEM;
+			goto out_free;
+		}
+
+		err = t->compress(src + i * block_size, blen, blocks[i].data,
+				  &blocks[i].len);
+		if (err) {
+			pr_err("%s: compressing block %u failed: %d\n",
+			       t->name, i, err);
+			goto out_free;
+		}
+		total += blocks[i].len;
+
+		err = t->decompress(blocks[i].data, blocks[i].len, out, &dlen);
+		if (err || dlen != blen || memcmp(out, src + i * block_size,
+						  blen)) {
+			pr_err("%s: block %u does not round trip\n",
+			       t->name, i);
+			err = -EINVAL;
+			goto out_free;
+		}
+	}
+
+	start = ktime_get();
+	for (n = 0; n < iterations; n++) {
+		for (i = 0; i < nblocks; i++) {
+			size_t dlen = block_size;
+
+			t->decompress(blocks[i].data, blocks[i].len, out,
+				      &dlen);
+		}
+		cond_resched();
+	}
+	report(t->name, total, len, ktime_to_ns(ktime_sub(ktime_get(), start)),
+	       iterations * nblocks);
+
+out_free:
+	for (i = 0; i < nblocks; i++)
+		kfree(blocks[i].data);
+	kfree(blocks);
+out_exit:
+	t->exit();
+	return err;
+}
+
+static int run_xz_test(void)
+{
+	const struct firmware *fw;
+	struct xz_dec *s;
+	struct xz_buf b;
+	struct device *dev;
+	size_t out_size = 0;
+	unsigned int n;
+	ktime_t start;
+	u64 ns = 0;
+	void *out;
+	int err;
+
+	dev = root_device_register(KBUILD_MODNAME);
+	if (IS_ERR(dev))
+		return PTR_ERR(dev);
+
+	err = request_firmware(&fw, xz_file, dev);
+	if (err)
+		goto out_dev;
+
+	/* Single-call mode decodes straight into a buffer of 'size' bytes */
+	out = vmalloc(size);
+	s = xz_dec_init(XZ_SINGLE, 0);
+	if (!out || !s) {
+		err = -ENOMEM;
+		goto out_free;
+	}
+
+	for (n = 0; n < iterations; n++) {
+		b.in = fw->data;
+		b.in_pos = 0;
+		b.in_size = fw->size;
+		b.out = out;
+		b.out_pos = 0;
+		b.out_size = size;
+
+		xz_dec_reset(s);
+		start = ktime_get();
+		err = xz_dec_run(s, &b);
+		ns += ktime_to_ns(ktime_sub(ktime_get(), start));
+		if (err != XZ_STREAM_END) {
+			pr_err("xz: %s does not decode (%d), is 'size' large enough?\n",
+			       xz_file, err);
+			err = -EINVAL;
+			goto out_free;
+		}
+		out_size = b.out_pos;
+		cond_resched();
+	}
+	err = 0;
+	report("xz", fw->size, out_size, ns, iterations);
+
+out_free:
+	xz_dec_end(s);
+	vfree(out);
+	release_firmware(fw);
+out_dev:
+	root_device_unregister(dev);
+	return err;
+}
+
+#define SAMPLE_SEED	0x6b65726e656cULL
+
+static const char * const sample_words[] = {
+	"the ", "kernel ", "inode ", "block ", "page ", "struct ", "return ",
+	"0x0000", "error ", "device ", "\n\t", "if (", ") {\n", "NULL", "; ",
+};
+
+/*
+ * Fill @buf with 256 byte chunks: three in four are words picked at
+ * random from a small dictionary, the rest are zeroes or random bytes.
+ */
+static void fill_sample(u8 *buf, size_t len)
+{
+	struct rnd_state rnd;
+	size_t pos = 0;
+
+	prandom_seed_state(&rnd, SAMPLE_SEED);
+	while (pos < len) {
+		size_t chunk = min_t(size_t, 256, len - pos);
+		u32 kind = prandom_u32_state(&rnd) & 7;
+		size_t end = pos + chunk;
+
+		if (kind == 0) {
+			memset(buf + pos, 0, chunk);
+		} else if (kind == 1) {
+			prandom_bytes_state(&rnd, buf + pos, chunk);
+		} else {
+			while (pos < end) {
+				const char *w = sample_words[
+					prandom_u32_state(&rnd) %
+					ARRAY_SIZE(sample_words)];
+				size_t n = min(strlen(w), end - pos);
+
+				memcpy(buf + pos, w, n);
+				pos += n;
+			}
+		}
+		pos = end;
+	}
+}
+
+static int __init test_decompress_init(void)
+{
+	unsigned int i;
+	u8 *sample, *out;
+
+	if (!size || !block_size || !iterations)
+		return -EINVAL;
+
+	sample = vmalloc(size);
+	out = vmalloc(block_size);
+	if (!sample || !out) {
+		vfree(out);
+		vfree(sample);
+		return -ENOMEM;
+	}
+	fill_sample(sample, size);
+
+	pr_info("%u bytes in %u byte blocks, %u passes\n", size, block_size,
+		iterations);
+
+	for (i = 0; i < ARRAY_SIZE(decomp_tests); i++)
+		run_test(&decomp_tests[i], sample, size, out);
+	vfree(out);
+	vfree(sample);
+
+	if (xz_file)
+		run_xz_test();
+	else
+		pr_info("xz  : skipped, no xz_file given\n");
+
+	return 0;
+}
+
+static void __exit test_decompress_exit(void)
+{
+}
+
+module_init(test_decompress_init);
+module_exit(test_decompress_exit);
+
+MODULE_DESCRIPTION("Decompression speed test");
+MODULE_LICENSE("GPL");
@@ -18,9 +18,15 @@
 #include <linux/miscdevice.h>
 #include <linux/slab.h>
 #include <linux/uaccess.h>
+#include <linux/vmalloc.h>
+
+#define TEST_CHUNK_SIZE	1024
 
 static DEFINE_MUTEX(test_fw_mutex);
 static const struct firmware *test_firmware;
+/* image read back with request_firmware_chunk() */
+static u8 *test_chunked;
+static size_t test_chunked_size;
 
 static ssize_t test_fw_misc_read(struct file *f, char __user *buf,
 				 size_t size, loff_t *offset)
@@ -32,6 +38,9 @@ static ssize_t test_fw_misc_read(struct file *f, char __user *buf,
 		rc = simple_read_from_buffer(buf, size, offset,
 					     test_firmware->data,
 					     test_firmware->size);
+	else if (test_chunked)
+		rc = simple_read_from_buffer(buf, size, offset,
+					     test_chunked, test_chunked_size);
 	mutex_unlock(&test_fw_mutex);
 	return rc;
 }
@@ -64,6 +73,8 @@ static ssize_t trigger_request_store(struct device *dev,
 	mutex_lock(&test_fw_mutex);
 	release_firmware(test_firmware);
 	test_firmware = NULL;
+	vfree(test_chunked);
+	test_chunked = NULL;
 	rc = request_firmware(&test_firmware, name, dev);
 	if (rc)
 		pr_info("load of '%s' failed: %d\n", name, rc);
@@ -76,6 +87,62 @@ static ssize_t trigger_request_store(struct device *dev,
 }
 static DEVICE_ATTR_WO(trigger_request);
 
+/* Read the image TEST_CHUNK_SIZE bytes at a time, growing the buffer */
+static ssize_t trigger_chunk_request_store(struct device *dev,
+					   struct device_attribute *attr,
+					   const char *buf, size_t count)
+{
+	size_t size = 0, alloc = 0;
+	u8 *data = NULL, *tmp;
+	ssize_t rc;
+	char *name;
+
+	name = kzalloc(count + 1, GFP_KERNEL);
+	if (!name)
+		return -ENOSPC;
+	memcpy(name, buf, count);
+
+	pr_info("loading '%s' in chunks\n", name);
+
+	do {
+		if (size + TEST_CHUNK_SIZE > alloc) {
+			alloc = max_t(size_t, 2 * alloc, TEST_CHUNK_SIZE);
+			tmp = vmalloc(alloc);
+			if (!tmp) {
+				rc = -ENOMEM;
+				break;
+			}
+			memcpy(tmp, data, size);
+			vfree(data);
+			data = tmp;
+		}
+		rc = request_firmware_chunk(name, dev, data + size,
+					    TEST_CHUNK_SIZE, size);
+		if (rc > 0)
+			size += rc;
+	} while (rc > 0);
+
+	mutex_lock(&test_fw_mutex);
+	release_firmware(test_firmware);
+	test_firmware = NULL;
+	vfree(test_chunked);
+	test_chunked = NULL;
+	if (rc) {
+		pr_info("chunked load of '%s' failed: %zd\n", name, rc);
+		vfree(data);
+	} else {
+		test_chunked = data;
+		test_chunked_size = size;
+	}
+	pr_info("loaded: %zu\n", test_chunked ? test_chunked_size : 0);
+	mutex_unlock(&test_fw_mutex);
+
+	kfree(name);
+
+	return count;
+}
+static DEVICE_ATTR_WO(trigger_chunk_request);
+
 static int __init test_firmware_init(void)
 {
 	int rc;
@@ -91,10 +158,19 @@ static int __init test_firmware_init(void)
 		pr_err("could not create sysfs interface: %d\n", rc);
 		goto dereg;
 	}
+	rc = device_create_file(test_fw_misc_device.this_device,
+				&dev_attr_trigger_chunk_request);
+	if (rc) {
+		pr_err("could not create sysfs interface: %d\n", rc);
+		goto remove_request;
+	}
 
 	pr_warn("interface ready\n");
 
 	return 0;
+remove_request:
+	device_remove_file(test_fw_misc_device.this_device,
+			   &dev_attr_trigger_request);
 dereg:
 	misc_deregister(&test_fw_misc_device);
 	return rc;
@@ -105,6 +181,9 @@ module_init(test_firmware_init);
 static void __exit test_firmware_exit(void)
 {
 	release_firmware(test_firmware);
+	vfree(test_chunked);
+	device_remove_file(test_fw_misc_device.this_device,
+			   &dev_attr_trigger_chunk_request);
 	device_remove_file(test_fw_misc_device.this_device,
 			   &dev_attr_trigger_request);
 	misc_deregister(&test_fw_misc_device);
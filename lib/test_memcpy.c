@@ -0,0 +1,172 @@
+/*
+ * Bandwidth test for memcpy(), memcpy_large(), copy_page() and
+ * copy_page_neon().
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * memcpy_large() is first checked against memcpy() at random offsets and
+ * lengths, and copy_page_neon() on random pages of the buffer, then each
+ * routine is timed.  On ARM, copy.neon_min_len can be raised at run time
+ * to time the same calls without NEON.
+ */
+
+#define pr_fmt(fmt) KBUILD_MODNAME ": " fmt
+
+#include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/mm.h>
+#include <linux/module.h>
+#include <linux/random.h>
+#include <linux/sched.h>
+#include <linux/string.h>
+#include <linux/vmalloc.h>
+#include <asm/page.h>
+
+#ifndef CONFIG_ARM
+/* Only ARM has a NEON copy_page_neon(), elsewhere it is copy_page() */
+#define copy_page_neon(to, from)	copy_page(to, from)
+#endif
+
+#define TEST_MAX_SIZE	(1024 * 1024)
+#define TEST_BUF_SIZE	(TEST_MAX_SIZE + 128 + 64)
+
+static unsigned int total = 64 * 1024 * 1024;
+module_param(total, uint, 0444);
+MODULE_PARM_DESC(total, "Bytes to copy for each measurement (default 64M)");
+
+static unsigned int rounds = 1000;
+module_param(rounds, uint, 0444);
+MODULE_PARM_DESC(rounds, "Number of random correctness checks (default 1000)");
+
+static int test_correctness(u8 *src, u8 *dst, u8 *ref)
+{
+	unsigned int i;
+
+	for (i = 0; i < rounds; i++) {
+		unsigned int soff = prandom_u32() & 63;
+		unsigned int doff = prandom_u32() & 63;
+		unsigned int len = prandom_u32() % (i & 1 ? 8192 : TEST_MAX_SIZE);
+
+		memset(dst, 0, len + 128);
+		memset(ref, 0, len + 128);
+		memcpy(ref + doff, src + soff, len);
+		memcpy_large(dst + doff, src + soff, len);
+		if (memcmp(dst, ref, len + 128)) {
+			pr_err("memcpy_large(+%u, +%u, %u) differs from memcpy\n",
+			       doff, soff, len);
+			return -EINVAL;
+		}
+		cond_resched();
+	}
+
+	for (i = 0; i < rounds; i++) {
+		unsigned long off = (prandom_u32() % (TEST_MAX_SIZE / PAGE_SIZE)) *
+				    PAGE_SIZE;
+
+		memset(dst + off, 0, PAGE_SIZE);
+		memcpy(ref + off, src + off, PAGE_SIZE);
+		copy_page_neon(dst + off, src + off);
+		if (memcmp(dst + off, ref + off, PAGE_SIZE)) {
+			pr_err("copy_page_neon(+%lu) differs from memcpy\n", off);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+/* A byte per microsecond is a MB/s */
+static u64 mb_per_s(u64 bytes, ktime_t start)
+{
+	s64 us = ktime_us_delta(ktime_get(), start);
+
+	return div64_u64(bytes, max_t(s64, us, 1));
+}
+
+/*
+ * memcpy_large() only differs from memcpy() above a length cut-over, so
+ * print both for each length on one line to make it easy to spot.
+ */
+static void test_speed(u8 *src, u8 *dst)
+{
+	unsigned int len, n, passes;
+	u64 plain, large;
+	ktime_t start;
+
+	for (len = 256; len <= TEST_MAX_SIZE; len <<= 2) {
+		passes = max(total / len, 1U);
+
+		start = ktime_get();
+		for (n = 0; n < passes; n++)
+			memcpy(dst, src, len);
+		plain = mb_per_s((u64)len * passes, start);
+
+		start = ktime_get();
+		for (n = 0; n < passes; n++)
+			memcpy_large(dst, src, len);
+		large = mb_per_s((u64)len * passes, start);
+
+		pr_info("%7u bytes: memcpy %llu MB/s, memcpy_large %llu MB/s\n",
+			len, plain, large);
+
+		cond_resched();
+	}
+
+	/* Walk the whole buffer so that the source isn't always in cache */
+	passes = max(total / (unsigned int)PAGE_SIZE, 1U);
+	start = ktime_get();
+	for (n = 0; n < passes; n++) {
+		unsigned long off = (n * PAGE_SIZE) % TEST_MAX_SIZE;
+
+		copy_page(dst + off, src + off);
+	}
+	plain = mb_per_s((u64)PAGE_SIZE * passes, start);
+
+	start = ktime_get();
+	for (n = 0; n < passes; n++) {
+		unsigned long off = (n * PAGE_SIZE) % TEST_MAX_SIZE;
+
+		copy_page_neon(dst + off, src + off);
+	}
+	large = mb_per_s((u64)PAGE_SIZE * passes, start);
+
+	pr_info("%7lu bytes: copy_page %llu MB/s, copy_page_neon %llu MB/s\n",
+		(unsigned long)PAGE_SIZE, plain, large);
+}
+
+static int __init test_memcpy_init(void)
+{
+	u8 *src, *dst, *ref;
+	int ret = -ENOMEM;
+
+	src = vmalloc(TEST_BUF_SIZE);
+	dst = vmalloc(TEST_BUF_SIZE);
+	ref = vmalloc(TEST_BUF_SIZE);
+	if (!src || !dst || !ref)
+		goto out;
+
+	prandom_bytes(src, TEST_BUF_SIZE);
+
+	ret = test_correctness(src, dst, ref);
+	if (!ret)
+		test_speed(src, dst);
+
+out:
+	vfree(ref);
+	vfree(dst);
+	vfree(src);
+	return ret;
+}
+
+static void __exit test_memcpy_exit(void)
+{
+}
+
+module_init(test_memcpy_init);
+module_exit(test_memcpy_exit);
+
+MODULE_DESCRIPTION("memcpy and copy_page bandwidth test");
+MODULE_LICENSE("GPL");
@@ -346,6 +346,7 @@ static inline void dict_put(struct dictionary *dict, uint8_t byte)
 static bool dict_repeat(struct dictionary *dict, uint32_t *len, uint32_t dist)
 {
 	size_t back;
+	size_t copy_size;
 	uint32_t left;
 
 	if (dist >= dict->full || dist >= dict->size)
@@ -358,11 +359,30 @@ static bool dict_repeat(struct dictionary *dict, uint32_t *len, uint32_t dist)
 	if (dist >= dict->pos)
 		back += dict->end;
 
+	/*
+	 * Copy in pieces instead of a byte at a time. The destination never
+	 * wraps since dict->limit is at most dict->end. A source behind the
+	 * destination ends where the destination begins: if the repeat is
+	 * longer than the distance, what has been copied so far is a valid
+	 * source for a piece twice as long in the next round.
+	 */
 	do {
-		dict->buf[dict->pos++] = dict->buf[back++];
-		if (back == dict->end)
-			back = 0;
-	} while (--left > 0);
+		if (back < dict->pos) {
+			copy_size = min_t(size_t, dict->pos - back, left);
+			memcpy(dict->buf + dict->pos, dict->buf + back,
+					copy_size);
+		} else {
+			copy_size = min_t(size_t, dict->end - back, left);
+			memmove(dict->buf + dict->pos, dict->buf + back,
+					copy_size);
+			back += copy_size;
+			if (back == dict->end)
+				back = 0;
+		}
+
+		dict->pos += copy_size;
+		left -= copy_size;
+	} while (left > 0);
 
 	if (dict->full < dict->pos)
 		dict->full = dict->pos;
@@ -515,6 +535,31 @@ static __always_inline int rc_bit(struct rc_dec *rc, uint16_t *prob)
 	return bit;
 }
 
+/*
+ * Decode one bit without branching on its value. Bits that steer the
+ * decoder (is_match, is_rep and friends) are well predicted and use
+ * rc_bit(), but the bits of literals, lengths and distances are close to
+ * random and a mispredicted branch costs more than computing both outcomes
+ * and selecting one with a mask.
+ */
+static __always_inline uint32_t rc_bit_masked(struct rc_dec *rc,
+					      uint16_t *prob)
+{
+	uint32_t bound;
+	uint32_t mask;
+	uint32_t p = *prob;
+
+	rc_normalize(rc);
+	bound = (rc->range >> RC_BIT_MODEL_TOTAL_BITS) * p;
+	mask = (uint32_t)0 - (rc->code >= bound);
+	rc->range = (bound & ~mask) | ((rc->range - bound) & mask);
+	rc->code -= bound & mask;
+	*prob = p + (((RC_BIT_MODEL_TOTAL - p) >> RC_MOVE_BITS) & ~mask)
+			- ((p >> RC_MOVE_BITS) & mask);
+
+	return mask & 1;
+}
+
 /* Decode a bittree starting from the most significant bit. */
 static __always_inline uint32_t rc_bittree(struct rc_dec *rc,
 					   uint16_t *probs, uint32_t limit)
@@ -522,10 +567,7 @@ static __always_inline uint32_t rc_bittree(struct rc_dec *rc,
 	uint32_t symbol = 1;
 
 	do {
-		if (rc_bit(rc, &probs[symbol]))
-			symbol = (symbol << 1) + 1;
-		else
-			symbol <<= 1;
+		symbol = (symbol << 1) + rc_bit_masked(rc, &probs[symbol]);
 	} while (symbol < limit);
 
 	return symbol;
@@ -537,15 +579,13 @@ static __always_inline void rc_bittree_reverse(struct rc_dec *rc,
 					       uint32_t *dest, uint32_t limit)
 {
 	uint32_t symbol = 1;
+	uint32_t bit;
 	uint32_t i = 0;
 
 	do {
-		if (rc_bit(rc, &probs[symbol])) {
-			symbol = (symbol << 1) + 1;
-			*dest += 1 << i;
-		} else {
-			symbol <<= 1;
-		}
+		bit = rc_bit_masked(rc, &probs[symbol]);
+		symbol = (symbol << 1) + bit;
+		*dest += bit << i;
 	} while (++i < limit);
 }
 
@@ -577,20 +617,32 @@ static uint16_t *lzma_literal_probs(struct xz_dec_lzma2 *s)
 	return s->lzma.literal[low + high];
 }
 
-/* Decode a literal (one 8-bit byte) */
-static void lzma_literal(struct xz_dec_lzma2 *s)
+/*
+ * Decode a literal (one 8-bit byte), followed by as many further literals
+ * as the is_match bits allow. Returns true if decoding stopped because an
+ * is_match bit said a match follows; that bit has then been consumed
+ * already. Returns false if the dictionary or input limit was reached.
+ *
+ * Runs of literals are common, so the range decoder is kept in a local
+ * copy. Since the kernel is built with -fno-strict-aliasing, the compiler
+ * would otherwise have to reload it after every probability update.
+ */
+static bool lzma_literals(struct xz_dec_lzma2 *s)
 {
+	struct rc_dec rc = s->rc;
 	uint16_t *probs;
 	uint32_t symbol;
 	uint32_t match_byte;
 	uint32_t match_bit;
 	uint32_t offset;
+	uint32_t pos_state;
+	uint32_t bit;
 	uint32_t i;
 
 	probs = lzma_literal_probs(s);
 
 	if (lzma_state_is_literal(s->lzma.state)) {
-		symbol = rc_bittree(&s->rc, probs, 0x100);
+		symbol = rc_bittree(&rc, probs, 0x100);
 	} else {
 		symbol = 1;
 		match_byte = dict_get(&s->dict, s->lzma.rep0) << 1;
@@ -601,18 +653,32 @@ static void lzma_literal(struct xz_dec_lzma2 *s)
 			match_byte <<= 1;
 			i = offset + match_bit + symbol;
 
-			if (rc_bit(&s->rc, &probs[i])) {
-				symbol = (symbol << 1) + 1;
-				offset &= match_bit;
-			} else {
-				symbol <<= 1;
-				offset &= ~match_bit;
-			}
+			bit = rc_bit_masked(&rc, &probs[i]);
+			symbol = (symbol << 1) + bit;
+			offset &= ~(match_bit ^ ((uint32_t)0 - bit));
 		} while (symbol < 0x100);
 	}
 
 	dict_put(&s->dict, (uint8_t)symbol);
 	lzma_state_literal(&s->lzma.state);
+
+	/* After a literal, the next literal is never a matched one. */
+	while (dict_has_space(&s->dict) && !rc_limit_exceeded(&rc)) {
+		pos_state = s->dict.pos & s->lzma.pos_mask;
+
+		if (rc_bit(&rc, &s->lzma.is_match[s->lzma.state][pos_state])) {
+			s->rc = rc;
+			return true;
+		}
+
+		probs = lzma_literal_probs(s);
+		symbol = rc_bittree(&rc, probs, 0x100);
+		dict_put(&s->dict, (uint8_t)symbol);
+		lzma_state_literal(&s->lzma.state);
+	}
+
+	s->rc = rc;
+	return false;
 }
 
 /* Decode the length of the match into s->lzma.len. */
@@ -739,16 +805,19 @@ static bool lzma_main(struct xz_dec_lzma2 *s)
 
 		if (!rc_bit(&s->rc, &s->lzma.is_match[
 				s->lzma.state][pos_state])) {
-			lzma_literal(s);
-		} else {
-			if (rc_bit(&s->rc, &s->lzma.is_rep[s->lzma.state]))
-				lzma_rep_match(s, pos_state);
-			else
-				lzma_match(s, pos_state);
+			if (!lzma_literals(s))
+				continue;
 
-			if (!dict_repeat(&s->dict, &s->lzma.len, s->lzma.rep0))
-				return false;
+			pos_state = s->dict.pos & s->lzma.pos_mask;
 		}
+
+		if (rc_bit(&s->rc, &s->lzma.is_rep[s->lzma.state]))
+			lzma_rep_match(s, pos_state);
+		else
+			lzma_match(s, pos_state);
+
+		if (!dict_repeat(&s->dict, &s->lzma.len, s->lzma.rep0))
+			return false;
 	}
 
 	/*
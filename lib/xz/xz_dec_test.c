@@ -12,6 +12,8 @@
 #include <linux/fs.h>
 #include <linux/uaccess.h>
 #include <linux/crc32.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
 #include <linux/xz.h>
 
 /* Maximum supported dictionary size */
@@ -61,6 +63,14 @@ static struct xz_buf buffers = {
  */
 static uint32_t crc;
 
+/*
+ * Time spent in xz_dec_run() and the amount of uncompressed data it
+ * produced. Writing the compressed blocks of a real filesystem image to
+ * the device gives a decoder benchmark that excludes the I/O.
+ */
+static u64 decode_ns;
+static u64 decoded_bytes;
+
 static int xz_dec_test_open(struct inode *i, struct file *f)
 {
 	if (device_is_open)
@@ -71,6 +81,8 @@ static int xz_dec_test_open(struct inode *i, struct file *f)
 	xz_dec_reset(state);
 	ret = XZ_OK;
 	crc = 0xFFFFFFFF;
+	decode_ns = 0;
+	decoded_bytes = 0;
 
 	buffers.in_pos = 0;
 	buffers.in_size = 0;
@@ -103,6 +115,7 @@ static ssize_t xz_dec_test_write(struct file *file, const char __user *buf,
 				 size_t size, loff_t *pos)
 {
 	size_t remaining;
+	ktime_t start;
 
 	if (ret != XZ_OK) {
 		if (size > 0)
@@ -130,7 +143,10 @@ static ssize_t xz_dec_test_write(struct file *file, const char __user *buf,
 		}
 
 		buffers.out_pos = 0;
+		start = ktime_get();
 		ret = xz_dec_run(state, &buffers);
+		decode_ns += ktime_to_ns(ktime_sub(ktime_get(), start));
+		decoded_bytes += buffers.out_pos;
 		crc = crc32(crc, buffer_out, buffers.out_pos);
 	}
 
@@ -142,6 +158,12 @@ static ssize_t xz_dec_test_write(struct file *file, const char __user *buf,
 	case XZ_STREAM_END:
 		printk(KERN_INFO DEVICE_NAME ": XZ_STREAM_END, "
 				"CRC32 = 0x%08X\n", ~crc);
+		printk(KERN_INFO DEVICE_NAME ": %llu bytes decoded in "
+				"%llu us (%llu KiB/s)\n", decoded_bytes,
+				div_u64(decode_ns, NSEC_PER_USEC),
+				decode_ns ? div64_u64(decoded_bytes
+						* NSEC_PER_SEC / 1024,
+						decode_ns) : 0);
 		return size - remaining - (buffers.in_size - buffers.in_pos);
 
 	case XZ_MEMLIMIT_ERROR:
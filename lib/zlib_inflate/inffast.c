@@ -10,43 +10,79 @@
 
 #ifndef ASMINF
 
-/* Allow machine dependent optimization for post-increment or pre-increment.
-   Based on testing to date,
-   Pre-increment preferred for:
-   - PowerPC G3 (Adler)
-   - MIPS R5000 (Randers-Pehrson)
-   Post-increment preferred for:
-   - none
-   No measurable difference:
-   - Pentium III (Anderson)
-   - M68060 (Nikl)
+/*
+ * The bit accumulator is 64 bits wide and refilled a whole word at a time,
+ * and matches are copied in 8 byte chunks.  Both may touch a few bytes
+ * beyond what is strictly needed, which is what INFLATE_FAST_MIN_INPUT and
+ * INFLATE_FAST_MIN_OUTPUT account for.  memcpy() with a constant size is
+ * used for the unaligned accesses so that this file still builds in the
+ * boot wrappers, which have no <asm/unaligned.h>.
  */
-union uu {
-	unsigned short us;
-	unsigned char b[2];
-};
+typedef unsigned long long inflate_holder_t;
 
-/* Endian independed version */
-static inline unsigned short
-get_unaligned16(const unsigned short *p)
-{
-	union uu  mm;
-	unsigned char *b = (unsigned char *)p;
+#define INFLATE_CHUNK_SIZE	8
 
-	mm.b[0] = b[0];
-	mm.b[1] = b[1];
-	return mm.us;
-}
+/* Load 8 bytes of input as a little endian word */
+static inline inflate_holder_t load_le64(const unsigned char *p)
+{
+#ifdef __LITTLE_ENDIAN
+    inflate_holder_t v;
 
-#ifdef POSTINC
-#  define OFF 0
-#  define PUP(a) *(a)++
-#  define UP_UNALIGNED(a) get_unaligned16((a)++)
+    memcpy(&v, p, sizeof(v));
+    return v;
 #else
-#  define OFF 1
-#  define PUP(a) *++(a)
-#  define UP_UNALIGNED(a) get_unaligned16(++(a))
+    return (inflate_holder_t)p[0] | (inflate_holder_t)p[1] << 8 |
+           (inflate_holder_t)p[2] << 16 | (inflate_holder_t)p[3] << 24 |
+           (inflate_holder_t)p[4] << 32 | (inflate_holder_t)p[5] << 40 |
+           (inflate_holder_t)p[6] << 48 | (inflate_holder_t)p[7] << 56;
 #endif
+}
+
+static inline void copy_chunk(unsigned char *out, const unsigned char *from)
+{
+    memcpy(out, from, INFLATE_CHUNK_SIZE);
+}
+
+/*
+   Copy len >= 1 bytes of a match at distance dist from out, in whole
+   chunks, and return the new end of output.  Up to INFLATE_CHUNK_SIZE - 1
+   bytes past the end of the match are clobbered.
+
+   When the distance is shorter than a chunk the source and destination
+   overlap.  The first chunk is then copied a byte at a time, which lays
+   out enough of the repeating pattern that the rest can be copied from the
+   nearest multiple of dist at least a chunk back.
+ */
+static inline unsigned char *chunk_copy(unsigned char *out, unsigned dist,
+                                        unsigned len)
+{
+    /* smallest multiple of the distance that is at least a chunk */
+    static const unsigned char lapped[INFLATE_CHUNK_SIZE] = {
+        0, 8, 8, 9, 8, 10, 12, 14
+    };
+    const unsigned char *from = out - dist;
+
+    if (dist < INFLATE_CHUNK_SIZE) {
+        unsigned n = len < INFLATE_CHUNK_SIZE ? len : INFLATE_CHUNK_SIZE;
+
+        len -= n;
+        do {
+            *out++ = *from++;
+        } while (--n);
+        if (!len)
+            return out;
+        from = out - lapped[dist];
+    }
+
+    for (;;) {
+        copy_chunk(out, from);
+        if (len <= INFLATE_CHUNK_SIZE)
+            return out + len;
+        out += INFLATE_CHUNK_SIZE;
+        from += INFLATE_CHUNK_SIZE;
+        len -= INFLATE_CHUNK_SIZE;
+    }
+}
 
 /*
    Decode literal, length, and distance codes and write out the resulting
@@ -59,8 +95,8 @@ get_unaligned16(const unsigned short *p)
    Entry assumptions:
 
         state->mode == LEN
-        strm->avail_in >= 6
-        strm->avail_out >= 258
+        strm->avail_in >= INFLATE_FAST_MIN_INPUT
+        strm->avail_out >= INFLATE_FAST_MIN_OUTPUT
         start >= strm->avail_out
         state->bits < 8
 
@@ -75,13 +111,15 @@ get_unaligned16(const unsigned short *p)
     - The maximum input bits used by a length/distance pair is 15 bits for the
       length code, 5 bits for the length extra, 15 bits for the distance code,
       and 13 bits for the distance extra.  This totals 48 bits, or six bytes.
-      Therefore if strm->avail_in >= 6, then there is enough input to avoid
-      checking for available input while decoding.
+      The accumulator is topped up to at least 56 bits once per code, so no
+      further refills are needed while decoding it.  A refill loads eight
+      bytes, so decoding stops when fewer than that are left.
 
     - The maximum bytes that a single length/distance pair can output is 258
-      bytes, which is the maximum length that can be coded.  inflate_fast()
-      requires strm->avail_out >= 258 for each loop to avoid checking for
-      output space.
+      bytes, which is the maximum length that can be coded.  Chunked copies
+      may write up to seven bytes more, so inflate_fast() requires
+      strm->avail_out >= 265 for each loop to avoid checking for output
+      space.
 
     - @start:	inflate()'s starting value for strm->avail_out
  */
@@ -100,7 +138,7 @@ void inflate_fast(z_streamp strm, unsigned start)
     unsigned whave;             /* valid bytes in the window */
     unsigned write;             /* window write index */
     unsigned char *window;      /* allocated sliding window, if wsize != 0 */
-    unsigned long hold;         /* local strm->hold */
+    inflate_holder_t hold;      /* local strm->hold */
     unsigned bits;              /* local strm->bits */
     code const *lcode;          /* local strm->lencode */
     code const *dcode;          /* local strm->distcode */
@@ -115,11 +153,11 @@ void inflate_fast(z_streamp strm, unsigned start)
 
     /* copy state to local variables */
     state = (struct inflate_state *)strm->state;
-    in = strm->next_in - OFF;
-    last = in + (strm->avail_in - 5);
-    out = strm->next_out - OFF;
+    in = strm->next_in;
+    last = in + (strm->avail_in - (INFLATE_FAST_MIN_INPUT - 1));
+    out = strm->next_out;
     beg = out - (start - strm->avail_out);
-    end = out + (strm->avail_out - 257);
+    end = out + (strm->avail_out - (INFLATE_FAST_MIN_OUTPUT - 1));
 #ifdef INFLATE_STRICT
     dmax = state->dmax;
 #endif
@@ -137,12 +175,15 @@ void inflate_fast(z_streamp strm, unsigned start)
     /* decode literals and length/distances until end-of-block or not enough
        input data or output space */
     do {
-        if (bits < 15) {
-            hold += (unsigned long)(PUP(in)) << bits;
-            bits += 8;
-            hold += (unsigned long)(PUP(in)) << bits;
-            bits += 8;
-        }
+        /*
+         * Top up to 56..63 bits.  Bits of the next byte that only partly
+         * fit are loaded too, but the next refill ORs the same value into
+         * the same position, so they need not be masked off.
+         */
+        hold |= load_le64(in) << bits;
+        in += (63 - bits) >> 3;
+        bits |= 56;
+
         this = lcode[hold & lmask];
       dolen:
         op = (unsigned)(this.bits);
@@ -150,26 +191,16 @@ void inflate_fast(z_streamp strm, unsigned start)
         bits -= op;
         op = (unsigned)(this.op);
         if (op == 0) {                          /* literal */
-            PUP(out) = (unsigned char)(this.val);
+            *out++ = (unsigned char)(this.val);
         }
         else if (op & 16) {                     /* length base */
             len = (unsigned)(this.val);
             op &= 15;                           /* number of extra bits */
             if (op) {
-                if (bits < op) {
-                    hold += (unsigned long)(PUP(in)) << bits;
-                    bits += 8;
-                }
                 len += (unsigned)hold & ((1U << op) - 1);
                 hold >>= op;
                 bits -= op;
             }
-            if (bits < 15) {
-                hold += (unsigned long)(PUP(in)) << bits;
-                bits += 8;
-                hold += (unsigned long)(PUP(in)) << bits;
-                bits += 8;
-            }
             this = dcode[hold & dmask];
           dodist:
             op = (unsigned)(this.bits);
@@ -179,14 +210,6 @@ void inflate_fast(z_streamp strm, unsigned start)
             if (op & 16) {                      /* distance base */
                 dist = (unsigned)(this.val);
                 op &= 15;                       /* number of extra bits */
-                if (bits < op) {
-                    hold += (unsigned long)(PUP(in)) << bits;
-                    bits += 8;
-                    if (bits < op) {
-                        hold += (unsigned long)(PUP(in)) << bits;
-                        bits += 8;
-                    }
-                }
                 dist += (unsigned)hold & ((1U << op) - 1);
 #ifdef INFLATE_STRICT
                 if (dist > dmax) {
@@ -205,15 +228,16 @@ void inflate_fast(z_streamp strm, unsigned start)
                         state->mode = BAD;
                         break;
                     }
-                    from = window - OFF;
+                    from = window;
                     if (write == 0) {           /* very common case */
                         from += wsize - op;
                         if (op < len) {         /* some from window */
                             len -= op;
                             do {
-                                PUP(out) = PUP(from);
+                                *out++ = *from++;
                             } while (--op);
-                            from = out - dist;  /* rest from output */
+                            out = chunk_copy(out, dist, len);
+                            continue;           /* rest from output */
                         }
                     }
                     else if (write < op) {      /* wrap around window */
@@ -222,16 +246,17 @@ void inflate_fast(z_streamp strm, unsigned start)
                         if (op < len) {         /* some from end of window */
                             len -= op;
                             do {
-                                PUP(out) = PUP(from);
+                                *out++ = *from++;
                             } while (--op);
-                            from = window - OFF;
+                            from = window;
                             if (write < len) {  /* some from start of window */
                                 op = write;
                                 len -= op;
                                 do {
-                                    PUP(out) = PUP(from);
+                                    *out++ = *from++;
                                 } while (--op);
-                                from = out - dist;      /* rest from output */
+                                out = chunk_copy(out, dist, len);
+                                continue;       /* rest from output */
                             }
                         }
                     }
@@ -240,68 +265,20 @@ void inflate_fast(z_streamp strm, unsigned start)
                         if (op < len) {         /* some from window */
                             len -= op;
                             do {
-                                PUP(out) = PUP(from);
+                                *out++ = *from++;
                             } while (--op);
-                            from = out - dist;  /* rest from output */
+                            out = chunk_copy(out, dist, len);
+                            continue;           /* rest from output */
                         }
                     }
-                    while (len > 2) {
-                        PUP(out) = PUP(from);
-                        PUP(out) = PUP(from);
-                        PUP(out) = PUP(from);
-                        len -= 3;
-                    }
-                    if (len) {
-                        PUP(out) = PUP(from);
-                        if (len > 1)
-                            PUP(out) = PUP(from);
-                    }
+                    /* the window is not padded, copy exactly */
+                    do {
+                        *out++ = *from++;
+                    } while (--len);
                 }
                 else {
-		    unsigned short *sout;
-		    unsigned long loops;
-
-                    from = out - dist;          /* copy direct from output */
-		    /* minimum length is three */
-		    /* Align out addr */
-		    if (!((long)(out - 1 + OFF) & 1)) {
-			PUP(out) = PUP(from);
-			len--;
-		    }
-		    sout = (unsigned short *)(out - OFF);
-		    if (dist > 2) {
-			unsigned short *sfrom;
-
-			sfrom = (unsigned short *)(from - OFF);
-			loops = len >> 1;
-			do
-#ifdef CONFIG_HAVE_EFFICIENT_UNALIGNED_ACCESS
-			    PUP(sout) = PUP(sfrom);
-#else
-			    PUP(sout) = UP_UNALIGNED(sfrom);
-#endif
-			while (--loops);
-			out = (unsigned char *)sout + OFF;
-			from = (unsigned char *)sfrom + OFF;
-		    } else { /* dist == 1 or dist == 2 */
-			unsigned short pat16;
-
-			pat16 = *(sout-1+OFF);
-			if (dist == 1) {
-				union uu mm;
-				/* copy one char pattern to both bytes */
-				mm.us = pat16;
-				mm.b[0] = mm.b[1];
-				pat16 = mm.us;
-			}
-			loops = len >> 1;
-			do
-			    PUP(sout) = pat16;
-			while (--loops);
-			out = (unsigned char *)sout + OFF;
-		    }
-		    if (len & 1)
-			PUP(out) = PUP(from);
+                    /* copy direct from output, minimum length is three */
+                    out = chunk_copy(out, dist, len);
                 }
             }
             else if ((op & 64) == 0) {          /* 2nd level distance code */
@@ -329,19 +306,23 @@ void inflate_fast(z_streamp strm, unsigned start)
         }
     } while (in < last && out < end);
 
-    /* return unused bytes (on entry, bits < 8, so in won't go too far back) */
+    /* return unused bytes (only whole bytes read ahead by the refill are
+       given back, so in won't go too far back) */
     len = bits >> 3;
     in -= len;
     bits -= len << 3;
     hold &= (1U << bits) - 1;
 
     /* update state and return */
-    strm->next_in = in + OFF;
-    strm->next_out = out + OFF;
-    strm->avail_in = (unsigned)(in < last ? 5 + (last - in) : 5 - (in - last));
+    strm->next_in = in;
+    strm->next_out = out;
+    strm->avail_in = (unsigned)(in < last ?
+                                (INFLATE_FAST_MIN_INPUT - 1) + (last - in) :
+                                (INFLATE_FAST_MIN_INPUT - 1) - (in - last));
     strm->avail_out = (unsigned)(out < end ?
-                                 257 + (end - out) : 257 - (out - end));
-    state->hold = hold;
+                                 (INFLATE_FAST_MIN_OUTPUT - 1) + (end - out) :
+                                 (INFLATE_FAST_MIN_OUTPUT - 1) - (out - end));
+    state->hold = (unsigned long)hold;
     state->bits = bits;
     return;
 }
@@ -351,7 +332,6 @@ void inflate_fast(z_streamp strm, unsigned start)
    - Using bit fields for code structure
    - Different op definition to avoid & for extra bits (do & for table bits)
    - Three separate decoding do-loops for direct, window, and write == 0
-   - Special case for distance > 1 copies to do overlapped load and store copy
    - Explicit branch predictions (based on measured branch probabilities)
    - Deferring match copy and interspersed it with decoding subsequent codes
    - Swapping literal/length else
@@ -8,4 +8,9 @@
    subject to change. Applications should only use zlib.h.
  */
 
+/* inflate_fast() reads whole words of input and writes whole chunks of
+   output, so it needs some slack beyond the longest code and match */
+#define INFLATE_FAST_MIN_INPUT	8
+#define INFLATE_FAST_MIN_OUTPUT	265
+
 void inflate_fast (z_streamp strm, unsigned start);
@@ -1737,9 +1737,9 @@ int skb_copy_bits(const struct sk_buff *skb, int offset, void *to, int len)
 				copy = len;
 
 			vaddr = kmap_atomic(skb_frag_page(f));
-			memcpy(to,
-			       vaddr + f->page_offset + offset - start,
-			       copy);
+			memcpy_large(to,
+				     vaddr + f->page_offset + offset - start,
+				     copy);
 			kunmap_atomic(vaddr);
 
 			if ((len -= copy) == 0)
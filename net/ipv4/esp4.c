@@ -13,6 +13,7 @@
 #include <linux/rtnetlink.h>
 #include <linux/slab.h>
 #include <linux/spinlock.h>
+#include <linux/percpu.h>
 #include <linux/in6.h>
 #include <net/icmp.h>
 #include <net/protocol.h>
@@ -25,17 +26,21 @@ struct esp_skb_cb {
 
 #define ESP_SKB_CB(__skb) ((struct esp_skb_cb *)&((__skb)->cb[0]))
 
+/* Per-CPU space for the temporary area of synchronous AEADs */
+#define ESP_SCRATCH_SIZE	4096
+
+static void * __percpu *esp_scratches;
+
 static u32 esp4_get_mtu(struct xfrm_state *x, int mtu);
 
 /*
- * Allocate an AEAD request structure with extra space for SG and IV.
+ * Size of an AEAD request structure with extra space for SG and IV.
  *
  * For alignment considerations the IV is placed at the front, followed
  * by the request and finally the SG list.
- *
- * TODO: Use spare space in skb for this where possible.
  */
-static void *esp_alloc_tmp(struct crypto_aead *aead, int nfrags, int seqhilen)
+static unsigned int esp_tmp_len(struct crypto_aead *aead, int nfrags,
+				int seqhilen)
 {
 	unsigned int len;
 
@@ -54,7 +59,37 @@ static void *esp_alloc_tmp(struct crypto_aead *aead, int nfrags, int seqhilen)
 
 	len += sizeof(struct scatterlist) * nfrags;
 
-	return kmalloc(len, GFP_ATOMIC);
+	return len;
+}
+
+/*
+ * Get the temporary area for a packet.  A synchronous AEAD is done with
+ * it by the time crypto_aead_*crypt() returns, so unless the packet has
+ * too many fragments it is taken from a per-CPU buffer instead of being
+ * allocated.  BHs stay disabled until esp_put_tmp() so that nothing else
+ * on this CPU can use the buffer in the meantime.
+ */
+static void *esp_get_tmp(struct crypto_aead *aead, int nfrags, int seqhilen,
+			 bool *scratch)
+{
+	unsigned int len = esp_tmp_len(aead, nfrags, seqhilen);
+
+	*scratch = len <= ESP_SCRATCH_SIZE &&
+		   !(crypto_aead_tfm(aead)->__crt_alg->cra_flags &
+		     CRYPTO_ALG_ASYNC);
+	if (!*scratch)
+		return kmalloc(len, GFP_ATOMIC);
+
+	local_bh_disable();
+	return *this_cpu_ptr(esp_scratches);
+}
+
+static void esp_put_tmp(void *tmp, bool scratch)
+{
+	if (scratch)
+		local_bh_enable();
+	else
+		kfree(tmp);
 }
 
 static inline __be32 *esp_tmp_seqhi(void *tmp)
@@ -135,6 +170,7 @@ static int esp_output(struct xfrm_state *x, struct sk_buff *skb)
 	int sglists;
 	int seqhilen;
 	__be32 *seqhi;
+	bool scratch;
 
 	/* skb is pure payload to encrypt */
 
@@ -169,7 +205,7 @@ static int esp_output(struct xfrm_state *x, struct sk_buff *skb)
 		assoclen += seqhilen;
 	}
 
-	tmp = esp_alloc_tmp(aead, nfrags + sglists, seqhilen);
+	tmp = esp_get_tmp(aead, nfrags + sglists, seqhilen, &scratch);
 	if (!tmp) {
 		err = -ENOMEM;
 		goto error;
@@ -267,7 +303,7 @@ static int esp_output(struct xfrm_state *x, struct sk_buff *skb)
 	if (err == -EBUSY)
 		err = NET_XMIT_DROP;
 
-	kfree(tmp);
+	esp_put_tmp(tmp, scratch);
 
 error:
 	return err;
@@ -385,6 +421,7 @@ static int esp_input(struct xfrm_state *x, struct sk_buff *skb)
 	u8 *iv;
 	struct scatterlist *sg;
 	struct scatterlist *asg;
+	bool scratch;
 	int err = -EINVAL;
 
 	if (!pskb_may_pull(skb, sizeof(*esph) + crypto_aead_ivsize(aead)))
@@ -410,7 +447,7 @@ static int esp_input(struct xfrm_state *x, struct sk_buff *skb)
 	}
 
 	err = -ENOMEM;
-	tmp = esp_alloc_tmp(aead, nfrags + sglists, seqhilen);
+	tmp = esp_get_tmp(aead, nfrags + sglists, seqhilen, &scratch);
 	if (!tmp)
 		goto out;
 
@@ -448,6 +485,10 @@ static int esp_input(struct xfrm_state *x, struct sk_buff *skb)
 	if (err == -EINPROGRESS)
 		goto out;
 
+	if (scratch) {
+		ESP_SKB_CB(skb)->tmp = NULL;
+		esp_put_tmp(tmp, scratch);
+	}
 	err = esp_input_done2(skb, err);
 
 out:
@@ -703,15 +744,56 @@ static struct xfrm4_protocol esp4_protocol = {
 	.priority	=	0,
 };
 
+static void esp_free_scratches(void)
+{
+	int i;
+
+	if (!esp_scratches)
+		return;
+
+	for_each_possible_cpu(i)
+		kfree(*per_cpu_ptr(esp_scratches, i));
+
+	free_percpu(esp_scratches);
+	esp_scratches = NULL;
+}
+
+static int esp_alloc_scratches(void)
+{
+	int i;
+
+	esp_scratches = alloc_percpu(void *);
+	if (!esp_scratches)
+		return -ENOMEM;
+
+	for_each_possible_cpu(i) {
+		void *scratch;
+
+		scratch = kmalloc_node(ESP_SCRATCH_SIZE, GFP_KERNEL,
+				       cpu_to_node(i));
+		if (!scratch) {
+			esp_free_scratches();
+			return -ENOMEM;
+		}
+		*per_cpu_ptr(esp_scratches, i) = scratch;
+	}
+
+	return 0;
+}
+
 static int __init esp4_init(void)
 {
+	if (esp_alloc_scratches())
+		return -ENOMEM;
 	if (xfrm_register_type(&esp_type, AF_INET) < 0) {
 		pr_info("%s: can't add xfrm type\n", __func__);
+		esp_free_scratches();
 		return -EAGAIN;
 	}
 	if (xfrm4_protocol_register(&esp4_protocol, IPPROTO_ESP) < 0) {
 		pr_info("%s: can't add protocol\n", __func__);
 		xfrm_unregister_type(&esp_type, AF_INET);
+		esp_free_scratches();
 		return -EAGAIN;
 	}
 	return 0;
@@ -723,6 +805,7 @@ static void __exit esp4_fini(void)
 		pr_info("%s: can't remove protocol\n", __func__);
 	if (xfrm_unregister_type(&esp_type, AF_INET) < 0)
 		pr_info("%s: can't remove xfrm type\n", __func__);
+	esp_free_scratches();
 }
 
 module_init(esp4_init);
@@ -786,8 +786,13 @@ int inet_csk_listen_start(struct sock *sk, const int nr_table_entries)
 {
 	struct inet_sock *inet = inet_sk(sk);
 	struct inet_connection_sock *icsk = inet_csk(sk);
-	int rc = reqsk_queue_alloc(&icsk->icsk_accept_queue, nr_table_entries);
+	int rc;
 
+	/* Children would share the upper layer protocol's state, e.g. kTLS's */
+	if (icsk->icsk_ulp_ops)
+		return -EINVAL;
+
+	rc = reqsk_queue_alloc(&icsk->icsk_accept_queue, nr_table_entries);
 	if (rc != 0)
 		return rc;
 
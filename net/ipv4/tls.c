@@ -0,0 +1,657 @@
+/*
+ * TLS record layer for TCP sockets, transmit side.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * User space does the handshake itself, then attaches the "tls" ULP to the
+ * connected socket and installs the negotiated key material with the TLS_TX
+ * socket option.  From then on everything written to the socket is framed
+ * into TLS 1.2 records, which are encrypted with AES-GCM in place and handed
+ * to TCP by reference with do_tcp_sendpages().  Since ->sendpage is covered
+ * as well, sendfile() of static content works on a TLS connection.
+ *
+ * Each socket builds one record at a time in a handful of private pages.
+ * A record is closed when it is full or when the caller stops passing
+ * MSG_MORE, and it must be completely queued to TCP before the next one is
+ * started.  If TCP's send buffer fills up on a non-blocking socket, the rest
+ * of the record is pushed from ->sk_write_space once room frees up.
+ */
+
+#define pr_fmt(fmt) "TLS: " fmt
+
+#include <linux/highmem.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/scatterlist.h>
+#include <linux/slab.h>
+#include <linux/tls.h>
+#include <crypto/aead.h>
+#include <net/tcp.h>
+
+#define TLS_HEADER_SIZE		5
+#define TLS_AAD_SIZE		13
+#define TLS_MAX_PAYLOAD_SIZE	(1 << 14)
+#define TLS_RECORD_TYPE_DATA	0x17
+
+/* header and explicit nonce in front of the payload, tag behind it */
+#define TLS_PREPEND_SIZE	(TLS_HEADER_SIZE + \
+				 TLS_CIPHER_AES_GCM_128_IV_SIZE)
+#define TLS_OVERHEAD_SIZE	(TLS_PREPEND_SIZE + \
+				 TLS_CIPHER_AES_GCM_128_TAG_SIZE)
+#define TLS_RECORD_PAGES	DIV_ROUND_UP(TLS_MAX_PAYLOAD_SIZE + \
+					     TLS_OVERHEAD_SIZE, PAGE_SIZE)
+
+enum {
+	TLSV4,
+	TLSV6,
+	TLS_NUM_PROTS,
+};
+
+enum {
+	TLS_BASE,
+	TLS_SW_TX,
+	TLS_NUM_CONFIG,
+};
+
+struct tls_context {
+	/* key material, iv and rec_seq advance with every record */
+	struct tls12_crypto_info_aes_gcm_128 crypto_send;
+	bool tx_conf;
+
+	struct crypto_aead *aead_send;
+	struct aead_request *aead_req;
+	u8 aad[TLS_AAD_SIZE];
+
+	/*
+	 * The record is open while rec_len > 0 and being pushed to TCP
+	 * while push_len > 0; it is never both.
+	 */
+	struct page *rec_pages[TLS_RECORD_PAGES];
+	unsigned int rec_len;
+	unsigned int push_off;
+	unsigned int push_len;
+	unsigned char rec_type;
+
+	struct proto *sk_proto;
+	void (*sk_write_space)(struct sock *sk);
+};
+
+static struct proto tls_prots[TLS_NUM_PROTS][TLS_NUM_CONFIG];
+static struct proto *saved_tcpv6_prot;
+static DEFINE_MUTEX(tcpv6_prot_mutex);
+
+static inline struct tls_context *tls_get_ctx(const struct sock *sk)
+{
+	return inet_csk(sk)->icsk_ulp_data;
+}
+
+/* Increment a big endian record sequence number or explicit nonce */
+static void tls_advance_seq(unsigned char *seq, int len)
+{
+	while (len-- && !++seq[len])
+		;
+}
+
+/* Make sure the open record has pages for len more bytes of payload */
+static int tls_rec_alloc(struct sock *sk, struct tls_context *ctx,
+			 unsigned int len)
+{
+	unsigned int end = ctx->rec_len + len + TLS_OVERHEAD_SIZE;
+	unsigned int i;
+
+	for (i = 0; i < DIV_ROUND_UP(end, PAGE_SIZE); i++) {
+		if (ctx->rec_pages[i])
+			continue;
+		ctx->rec_pages[i] = alloc_page(sk->sk_allocation);
+		if (!ctx->rec_pages[i])
+			return -ENOMEM;
+	}
+
+	return 0;
+}
+
+/* Append len bytes from an iterator to the open record */
+static size_t tls_rec_copy_from_iter(struct tls_context *ctx,
+				     struct iov_iter *from, size_t len)
+{
+	size_t copied = 0;
+
+	while (copied < len) {
+		unsigned int off = TLS_PREPEND_SIZE + ctx->rec_len;
+		unsigned int poff = off & ~PAGE_MASK;
+		size_t n = min_t(size_t, len - copied, PAGE_SIZE - poff);
+		size_t done;
+
+		done = copy_page_from_iter(ctx->rec_pages[off >> PAGE_SHIFT],
+					   poff, n, from);
+		ctx->rec_len += done;
+		copied += done;
+		if (done < n)
+			break;
+	}
+
+	return copied;
+}
+
+/* Append len bytes at src to the open record */
+static void tls_rec_copy(struct tls_context *ctx, const char *src,
+			 size_t len)
+{
+	while (len) {
+		unsigned int off = TLS_PREPEND_SIZE + ctx->rec_len;
+		unsigned int poff = off & ~PAGE_MASK;
+		size_t n = min_t(size_t, len, PAGE_SIZE - poff);
+
+		memcpy(page_address(ctx->rec_pages[off >> PAGE_SHIFT]) + poff,
+		       src, n);
+		ctx->rec_len += n;
+		src += n;
+		len -= n;
+	}
+}
+
+/*
+ * Queue what is left of the closed record to TCP.  Pages are released as
+ * soon as TCP has taken its own reference on them.
+ */
+static int tls_push_pending(struct sock *sk, struct tls_context *ctx,
+			    int flags)
+{
+	while (ctx->push_len) {
+		unsigned int i = ctx->push_off >> PAGE_SHIFT;
+		unsigned int off = ctx->push_off & ~PAGE_MASK;
+		size_t size = min_t(size_t, ctx->push_len, PAGE_SIZE - off);
+		int sendflags = flags;
+		ssize_t ret;
+
+		if (size < ctx->push_len)
+			sendflags |= MSG_SENDPAGE_NOTLAST;
+
+		ret = do_tcp_sendpages(sk, ctx->rec_pages[i], off, size,
+				       sendflags);
+		if (ret < 0)
+			return ret;
+
+		ctx->push_off += ret;
+		ctx->push_len -= ret;
+		if (ret == size) {
+			put_page(ctx->rec_pages[i]);
+			ctx->rec_pages[i] = NULL;
+		}
+	}
+
+	return 0;
+}
+
+/* Frame and encrypt the open record in place, then start pushing it */
+static int tls_push_record(struct sock *sk, struct tls_context *ctx,
+			   int flags)
+{
+	struct tls12_crypto_info_aes_gcm_128 *info = &ctx->crypto_send;
+	struct scatterlist sg_aad, sg[TLS_RECORD_PAGES];
+	u8 iv[TLS_CIPHER_AES_GCM_128_SALT_SIZE +
+	      TLS_CIPHER_AES_GCM_128_IV_SIZE];
+	unsigned int len = ctx->rec_len;
+	unsigned int off = TLS_PREPEND_SIZE;
+	unsigned int left = len + TLS_CIPHER_AES_GCM_128_TAG_SIZE;
+	unsigned int enc_len = TLS_CIPHER_AES_GCM_128_IV_SIZE + left;
+	u8 *hdr = page_address(ctx->rec_pages[0]);
+	int i, err;
+
+	hdr[0] = ctx->rec_type;
+	hdr[1] = TLS_1_2_VERSION_MAJOR;
+	hdr[2] = TLS_1_2_VERSION_MINOR;
+	hdr[3] = enc_len >> 8;
+	hdr[4] = enc_len;
+	memcpy(hdr + TLS_HEADER_SIZE, info->iv, sizeof(info->iv));
+
+	/* sequence number, type, version and plaintext length */
+	memcpy(ctx->aad, info->rec_seq, sizeof(info->rec_seq));
+	ctx->aad[8] = ctx->rec_type;
+	ctx->aad[9] = TLS_1_2_VERSION_MAJOR;
+	ctx->aad[10] = TLS_1_2_VERSION_MINOR;
+	ctx->aad[11] = len >> 8;
+	ctx->aad[12] = len;
+
+	memcpy(iv, info->salt, sizeof(info->salt));
+	memcpy(iv + sizeof(info->salt), info->iv, sizeof(info->iv));
+
+	sg_init_table(sg, TLS_RECORD_PAGES);
+	for (i = 0; left; i++) {
+		unsigned int poff = off & ~PAGE_MASK;
+		unsigned int n = min_t(unsigned int, left, PAGE_SIZE - poff);
+
+		sg_set_page(&sg[i], ctx->rec_pages[off >> PAGE_SHIFT], n, poff);
+		off += n;
+		left -= n;
+	}
+	sg_mark_end(&sg[i - 1]);
+	sg_init_one(&sg_aad, ctx->aad, sizeof(ctx->aad));
+
+	aead_request_set_tfm(ctx->aead_req, ctx->aead_send);
+	aead_request_set_callback(ctx->aead_req, 0, NULL, NULL);
+	aead_request_set_assoc(ctx->aead_req, &sg_aad, sizeof(ctx->aad));
+	aead_request_set_crypt(ctx->aead_req, sg, sg, len, iv);
+	err = crypto_aead_encrypt(ctx->aead_req);
+	if (err) {
+		/* a lost record breaks the stream for good */
+		sk->sk_err = EBADMSG;
+		sk->sk_error_report(sk);
+		return err;
+	}
+
+	tls_advance_seq(info->iv, sizeof(info->iv));
+	tls_advance_seq(info->rec_seq, sizeof(info->rec_seq));
+
+	ctx->rec_len = 0;
+	ctx->push_off = 0;
+	ctx->push_len = TLS_PREPEND_SIZE + len +
+			TLS_CIPHER_AES_GCM_128_TAG_SIZE;
+
+	return tls_push_pending(sk, ctx, flags);
+}
+
+/* Finish pushing the last record and close one of a different type */
+static int tls_prepare_record(struct sock *sk, struct tls_context *ctx,
+			      unsigned char record_type, int flags)
+{
+	int err;
+
+	err = tls_push_pending(sk, ctx, flags);
+	if (err)
+		return err;
+
+	if (ctx->rec_len && ctx->rec_type != record_type)
+		err = tls_push_record(sk, ctx, flags);
+
+	return err;
+}
+
+static int tls_process_cmsg(struct sock *sk, struct msghdr *msg,
+			    unsigned char *record_type)
+{
+	struct cmsghdr *cmsg;
+
+	for_each_cmsghdr(cmsg, msg) {
+		if (!CMSG_OK(msg, cmsg))
+			return -EINVAL;
+		if (cmsg->cmsg_level != SOL_TLS)
+			continue;
+
+		switch (cmsg->cmsg_type) {
+		case TLS_SET_RECORD_TYPE:
+			if (cmsg->cmsg_len < CMSG_LEN(sizeof(*record_type)))
+				return -EINVAL;
+			/* control records can't be merged with later data */
+			if (msg->msg_flags & MSG_MORE)
+				return -EINVAL;
+			*record_type = *(unsigned char *)CMSG_DATA(cmsg);
+			break;
+		default:
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+static int tls_sw_sendmsg(struct sock *sk, struct msghdr *msg, size_t size)
+{
+	struct tls_context *ctx = tls_get_ctx(sk);
+	unsigned char record_type = TLS_RECORD_TYPE_DATA;
+	int flags = msg->msg_flags & (MSG_DONTWAIT | MSG_NOSIGNAL);
+	bool eor = !(msg->msg_flags & MSG_MORE);
+	size_t copied = 0;
+	int err;
+
+	if (msg->msg_flags & ~(MSG_MORE | MSG_DONTWAIT | MSG_NOSIGNAL))
+		return -EOPNOTSUPP;
+
+	lock_sock(sk);
+
+	if (msg->msg_controllen) {
+		err = tls_process_cmsg(sk, msg, &record_type);
+		if (err)
+			goto out;
+	}
+
+	err = tls_prepare_record(sk, ctx, record_type, flags);
+	if (err)
+		goto out;
+
+	while (iov_iter_count(&msg->msg_iter)) {
+		size_t want = min_t(size_t, iov_iter_count(&msg->msg_iter),
+				    TLS_MAX_PAYLOAD_SIZE - ctx->rec_len);
+		size_t n;
+
+		err = tls_rec_alloc(sk, ctx, want);
+		if (err)
+			break;
+
+		ctx->rec_type = record_type;
+		n = tls_rec_copy_from_iter(ctx, &msg->msg_iter, want);
+		copied += n;
+		if (n < want) {
+			err = -EFAULT;
+			break;
+		}
+
+		if (ctx->rec_len == TLS_MAX_PAYLOAD_SIZE) {
+			err = tls_push_record(sk, ctx, flags |
+					      (iov_iter_count(&msg->msg_iter) ||
+					       !eor ? MSG_SENDPAGE_NOTLAST : 0));
+			if (err)
+				break;
+		}
+	}
+
+	if (!err && eor && ctx->rec_len)
+		err = tls_push_record(sk, ctx, flags);
+
+out:
+	release_sock(sk);
+	return copied ? copied : err;
+}
+
+static int tls_sw_sendpage(struct sock *sk, struct page *page, int offset,
+			   size_t size, int flags)
+{
+	struct tls_context *ctx = tls_get_ctx(sk);
+	bool eor = !(flags & (MSG_MORE | MSG_SENDPAGE_NOTLAST));
+	size_t copied = 0;
+	char *kaddr;
+	int err;
+
+	if (flags & ~(MSG_MORE | MSG_DONTWAIT | MSG_NOSIGNAL |
+		      MSG_SENDPAGE_NOTLAST))
+		return -EOPNOTSUPP;
+	flags &= MSG_DONTWAIT | MSG_NOSIGNAL;
+
+	lock_sock(sk);
+
+	err = tls_prepare_record(sk, ctx, TLS_RECORD_TYPE_DATA, flags);
+	if (err)
+		goto out;
+
+	kaddr = kmap(page);
+	while (size) {
+		size_t want = min_t(size_t, size,
+				    TLS_MAX_PAYLOAD_SIZE - ctx->rec_len);
+
+		err = tls_rec_alloc(sk, ctx, want);
+		if (err)
+			break;
+
+		ctx->rec_type = TLS_RECORD_TYPE_DATA;
+		tls_rec_copy(ctx, kaddr + offset, want);
+		offset += want;
+		size -= want;
+		copied += want;
+
+		if (ctx->rec_len == TLS_MAX_PAYLOAD_SIZE) {
+			err = tls_push_record(sk, ctx, flags |
+					      (size || !eor ?
+					       MSG_SENDPAGE_NOTLAST : 0));
+			if (err)
+				break;
+		}
+	}
+	kunmap(page);
+
+	if (!err && eor && ctx->rec_len)
+		err = tls_push_record(sk, ctx, flags);
+
+out:
+	release_sock(sk);
+	return copied ? copied : err;
+}
+
+static void tls_write_space(struct sock *sk)
+{
+	struct tls_context *ctx = tls_get_ctx(sk);
+
+	/* a blocked writer pushes its own record once it wakes up */
+	if (!sk->sk_write_pending && ctx->push_len) {
+		gfp_t sk_allocation = sk->sk_allocation;
+		int err;
+
+		sk->sk_allocation = GFP_ATOMIC;
+		err = tls_push_pending(sk, ctx, MSG_DONTWAIT | MSG_NOSIGNAL);
+		sk->sk_allocation = sk_allocation;
+
+		if (err)
+			return;
+	}
+
+	ctx->sk_write_space(sk);
+}
+
+static int tls_set_tx(struct sock *sk, char __user *optval,
+		      unsigned int optlen)
+{
+	struct tls_context *ctx = tls_get_ctx(sk);
+	struct tls12_crypto_info_aes_gcm_128 info;
+	struct crypto_aead *aead;
+	int ip_ver = sk->sk_family == AF_INET6 ? TLSV6 : TLSV4;
+	int err;
+
+	if (optlen != sizeof(info))
+		return -EINVAL;
+	if (copy_from_user(&info, optval, sizeof(info)))
+		return -EFAULT;
+	if (info.info.version != TLS_1_2_VERSION ||
+	    info.info.cipher_type != TLS_CIPHER_AES_GCM_128) {
+		err = -EINVAL;
+		goto out_wipe;
+	}
+
+	lock_sock(sk);
+
+	if (ctx->tx_conf) {
+		err = -EBUSY;
+		goto out;
+	}
+
+	aead = crypto_alloc_aead("gcm(aes)", 0, CRYPTO_ALG_ASYNC);
+	if (IS_ERR(aead)) {
+		err = PTR_ERR(aead);
+		goto out;
+	}
+
+	err = crypto_aead_setkey(aead, info.key, sizeof(info.key));
+	if (!err)
+		err = crypto_aead_setauthsize(aead,
+					      TLS_CIPHER_AES_GCM_128_TAG_SIZE);
+	if (err)
+		goto out_free_aead;
+
+	ctx->aead_req = aead_request_alloc(aead, GFP_KERNEL);
+	if (!ctx->aead_req) {
+		err = -ENOMEM;
+		goto out_free_aead;
+	}
+
+	ctx->aead_send = aead;
+	ctx->crypto_send = info;
+	ctx->rec_type = TLS_RECORD_TYPE_DATA;
+	ctx->sk_write_space = sk->sk_write_space;
+	sk->sk_write_space = tls_write_space;
+	sk->sk_prot = &tls_prots[ip_ver][TLS_SW_TX];
+	ctx->tx_conf = true;
+	goto out;
+
+out_free_aead:
+	crypto_free_aead(aead);
+out:
+	release_sock(sk);
+out_wipe:
+	memzero_explicit(&info, sizeof(info));
+	return err;
+}
+
+static int tls_get_tx(struct sock *sk, char __user *optval,
+		      int __user *optlen)
+{
+	struct tls_context *ctx = tls_get_ctx(sk);
+	int len, err = 0;
+
+	if (get_user(len, optlen))
+		return -EFAULT;
+	if (len < sizeof(struct tls_crypto_info))
+		return -EINVAL;
+
+	lock_sock(sk);
+	if (!ctx->tx_conf) {
+		err = -EBUSY;
+	} else {
+		/* either just the version and cipher, or everything */
+		if (len >= sizeof(ctx->crypto_send))
+			len = sizeof(ctx->crypto_send);
+		else
+			len = sizeof(struct tls_crypto_info);
+
+		if (copy_to_user(optval, &ctx->crypto_send, len) ||
+		    put_user(len, optlen))
+			err = -EFAULT;
+	}
+	release_sock(sk);
+
+	return err;
+}
+
+static int tls_setsockopt(struct sock *sk, int level, int optname,
+			  char __user *optval, unsigned int optlen)
+{
+	struct tls_context *ctx = tls_get_ctx(sk);
+
+	if (level != SOL_TLS)
+		return ctx->sk_proto->setsockopt(sk, level, optname, optval,
+						 optlen);
+
+	switch (optname) {
+	case TLS_TX:
+		return tls_set_tx(sk, optval, optlen);
+	default:
+		return -ENOPROTOOPT;
+	}
+}
+
+static int tls_getsockopt(struct sock *sk, int level, int optname,
+			  char __user *optval, int __user *optlen)
+{
+	struct tls_context *ctx = tls_get_ctx(sk);
+
+	if (level != SOL_TLS)
+		return ctx->sk_proto->getsockopt(sk, level, optname, optval,
+						 optlen);
+
+	switch (optname) {
+	case TLS_TX:
+		return tls_get_tx(sk, optval, optlen);
+	default:
+		return -ENOPROTOOPT;
+	}
+}
+
+static void tls_sk_proto_close(struct sock *sk, long timeout)
+{
+	struct tls_context *ctx = tls_get_ctx(sk);
+	struct proto *sk_proto = ctx->sk_proto;
+	int i;
+
+	lock_sock(sk);
+
+	if (ctx->tx_conf) {
+		/* flush what MSG_MORE left behind before the FIN */
+		if (!tls_push_pending(sk, ctx, MSG_NOSIGNAL) && ctx->rec_len)
+			tls_push_record(sk, ctx, MSG_NOSIGNAL);
+
+		for (i = 0; i < TLS_RECORD_PAGES; i++)
+			if (ctx->rec_pages[i])
+				put_page(ctx->rec_pages[i]);
+		aead_request_free(ctx->aead_req);
+		crypto_free_aead(ctx->aead_send);
+		memzero_explicit(&ctx->crypto_send, sizeof(ctx->crypto_send));
+		sk->sk_write_space = ctx->sk_write_space;
+	}
+
+	sk->sk_prot = sk_proto;
+	inet_csk(sk)->icsk_ulp_data = NULL;
+	release_sock(sk);
+
+	kfree(ctx);
+	sk_proto->close(sk, timeout);
+}
+
+static void tls_build_proto(struct proto *prot, const struct proto *base)
+{
+	prot[TLS_BASE] = *base;
+	prot[TLS_BASE].setsockopt = tls_setsockopt;
+	prot[TLS_BASE].getsockopt = tls_getsockopt;
+	prot[TLS_BASE].close = tls_sk_proto_close;
+
+	prot[TLS_SW_TX] = prot[TLS_BASE];
+	prot[TLS_SW_TX].sendmsg = tls_sw_sendmsg;
+	prot[TLS_SW_TX].sendpage = tls_sw_sendpage;
+}
+
+static int tls_init(struct sock *sk)
+{
+	int ip_ver = sk->sk_family == AF_INET6 ? TLSV6 : TLSV4;
+	struct tls_context *ctx;
+
+	/*
+	 * Only a connected socket, so that no children of a listener end up
+	 * sharing the context; inet_csk_listen_start() refuses the reverse.
+	 */
+	if (sk->sk_state != TCP_ESTABLISHED)
+		return -ENOTCONN;
+
+	/* tcpv6_prot is private to the ipv6 module, copy it on first use */
+	if (ip_ver == TLSV6 &&
+	    unlikely(sk->sk_prot != smp_load_acquire(&saved_tcpv6_prot))) {
+		mutex_lock(&tcpv6_prot_mutex);
+		if (likely(sk->sk_prot != saved_tcpv6_prot)) {
+			tls_build_proto(tls_prots[TLSV6], sk->sk_prot);
+			smp_store_release(&saved_tcpv6_prot, sk->sk_prot);
+		}
+		mutex_unlock(&tcpv6_prot_mutex);
+	}
+
+	ctx = kzalloc(sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return -ENOMEM;
+
+	ctx->sk_proto = sk->sk_prot;
+	inet_csk(sk)->icsk_ulp_data = ctx;
+	sk->sk_prot = &tls_prots[ip_ver][TLS_BASE];
+
+	return 0;
+}
+
+static struct tcp_ulp_ops tcp_tls_ulp_ops __read_mostly = {
+	.name	= "tls",
+	.owner	= THIS_MODULE,
+	.init	= tls_init,
+};
+
+static int __init tls_register(void)
+{
+	tls_build_proto(tls_prots[TLSV4], &tcp_prot);
+
+	return tcp_register_ulp(&tcp_tls_ulp_ops);
+}
+
+static void __exit tls_unregister(void)
+{
+	tcp_unregister_ulp(&tcp_tls_ulp_ops);
+}
+
+module_init(tls_register);
+module_exit(tls_unregister);
+
+MODULE_DESCRIPTION("Transport Layer Security support");
+MODULE_LICENSE("GPL");
+MODULE_ALIAS_TCP_ULP("tls");
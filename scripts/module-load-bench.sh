@@ -0,0 +1,71 @@
+#!/bin/sh
+#
+# Time loading a set of modules, one after another and all at once (the
+# way udev does at boot), to measure symbol resolution and module_mutex
+# contention.  Run as root on the target:
+#
+#	scripts/module-load-bench.sh [-r rounds] module...
+#
+# Each module is unloaded again after every round, so none of them may be
+# in use.  Dependencies are loaded by modprobe as usual and count towards
+# the time.
+
+rounds=10
+
+usage() {
+	echo "Usage: $0 [-r rounds] module..." >&2
+	exit 1
+}
+
+while getopts r: opt; do
+	case $opt in
+	r) rounds=$OPTARG ;;
+	*) usage ;;
+	esac
+done
+shift $((OPTIND - 1))
+[ $# -gt 0 ] || usage
+
+now() {
+	cut -d' ' -f1 /proc/uptime
+}
+
+unload() {
+	for m in "$@"; do
+		modprobe -r "$m" 2>/dev/null
+	done
+}
+
+# run <parallel> module... - prints the time taken in seconds
+run() {
+	parallel=$1
+	shift
+	start=$(now)
+	if [ "$parallel" = 1 ]; then
+		for m in "$@"; do
+			modprobe "$m" &
+		done
+		wait
+	else
+		for m in "$@"; do
+			modprobe "$m"
+		done
+	fi
+	end=$(now)
+	unload "$@"
+	echo "$start $end" | awk '{ printf "%.2f\n", $2 - $1 }'
+}
+
+unload "$@"
+for mode in 0 1; do
+	total=0
+	i=0
+	while [ $i -lt "$rounds" ]; do
+		t=$(run $mode "$@")
+		total=$(echo "$total $t" | awk '{ print $1 + $2 }')
+		i=$((i + 1))
+	done
+	[ $mode = 1 ] && what=parallel || what=sequential
+	echo "$total $rounds $# $what" |
+		awk '{ printf "%-10s %d modules: %.3f s per round\n", $4, $3, $1 / $2 }'
+done
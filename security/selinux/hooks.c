@@ -2861,11 +2861,33 @@ static int selinux_inode_readlink(struct dentry *dentry)
 	return dentry_has_perm(cred, dentry, FILE__READ);
 }
 
-static int selinux_inode_follow_link(struct dentry *dentry, struct nameidata *nameidata)
+static int selinux_inode_follow_link(struct dentry *dentry, struct inode *inode,
+				     bool rcu)
 {
 	const struct cred *cred = current_cred();
+	struct inode_security_struct *isec;
+	struct av_decision avd;
+	u32 sid, audited, denied;
+	int rc;
 
-	return dentry_has_perm(cred, dentry, FILE__READ);
+	if (!rcu)
+		return dentry_has_perm(cred, dentry, FILE__READ);
+
+	validate_creds(cred);
+
+	sid = cred_sid(cred);
+	isec = inode->i_security;
+
+	rc = avc_has_perm_noaudit(sid, isec->sid, isec->sclass, FILE__READ, 0,
+				  &avd);
+	audited = avc_audit_required(FILE__READ, &avd, rc, 0, &denied);
+	/*
+	 * Auditing wants the name of the link, which isn't stable in
+	 * RCU-walk; redo the check in ref-walk mode.
+	 */
+	if (unlikely(audited))
+		return -ECHILD;
+	return rc;
 }
 
 static noinline int audit_inode_permission(struct inode *inode,
@@ -0,0 +1,452 @@
+/*
+ * idle-replay - replay a trace of idle periods and interrupts to evaluate
+ * how well the next wakeup is predicted
+ *
+ * Copyright (C) 2015
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ *
+ * Record with the irq governor selected:
+ *
+ *	# cd /sys/kernel/debug/tracing
+ *	# echo 1 > events/irq/irq_handler_entry/enable
+ *	# echo 1 > events/power/cpu_idle_predict/enable
+ *	# sleep 60; cat trace > /tmp/idle.trace
+ *
+ * then run "idle-replay /tmp/idle.trace" anywhere.  For every idle period
+ * of the chosen CPU it compares the time actually spent idle with
+ *  - the time to the next timer event alone,
+ *  - what the kernel predicted, as recorded in the trace, and
+ *  - what the interrupt history model, re-run over the recorded
+ *    interrupts with the parameters given on the command line, predicts,
+ * so the model can be tuned without rebooting.  With -r, the predictions
+ * are also turned into idle states, given their target residencies, and
+ * compared with the deepest state that would have paid off.
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <getopt.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SLOTS	64
+#define MAX_STATES	10
+
+enum { EV_IRQ, EV_IDLE };
+
+struct event {
+	int type;
+	unsigned int cpu;
+	unsigned long long ts;		/* us */
+	unsigned int irq;
+	unsigned int timer_us, irq_us, measured_us;
+};
+
+struct irq_model {
+	unsigned long long last, interval;
+};
+
+struct slot {
+	unsigned int irq;
+	unsigned long long last, interval;
+};
+
+struct stats {
+	const char *name;
+	unsigned long n;
+	unsigned long long abs_err;
+	unsigned long close, longer, shorter;
+	unsigned long right, deeper, shallower;
+};
+
+static struct event *events;
+static unsigned long nr_events;
+
+static struct irq_model *irqs;
+static unsigned int nr_irqs;
+
+static struct slot slots[MAX_SLOTS];
+static unsigned int nr_slots = 8;
+static unsigned int stale = 4;
+static unsigned int weight_shift = 3;
+static unsigned int cpu;
+
+static unsigned int residency[MAX_STATES];
+static unsigned int nr_states;
+
+static char *excluded;
+static unsigned int nr_excluded;
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"Usage: %s [options] trace\n"
+		"  -c cpu      CPU whose idle periods to replay (default 0)\n"
+		"  -n slots    interrupts remembered (default 8)\n"
+		"  -s stale    intervals an interrupt may be late (default 4)\n"
+		"  -w shift    moving average weight 1/2^shift (default 3)\n"
+		"  -r us,...   target residencies of the idle states\n"
+		"  -x irq,...  interrupts to leave out besides timers\n",
+		prog);
+	exit(1);
+}
+
+static void add_event(const struct event *ev)
+{
+	static unsigned long size;
+
+	if (nr_events == size) {
+		size = size ? size * 2 : 4096;
+		events = realloc(events, size * sizeof(*events));
+		if (!events) {
+			perror("realloc");
+			exit(1);
+		}
+	}
+	events[nr_events++] = *ev;
+}
+
+static struct irq_model *irq_model(unsigned int irq)
+{
+	if (irq >= nr_irqs) {
+		unsigned int n = irq + 1;
+
+		irqs = realloc(irqs, n * sizeof(*irqs));
+		if (!irqs) {
+			perror("realloc");
+			exit(1);
+		}
+		memset(irqs + nr_irqs, 0, (n - nr_irqs) * sizeof(*irqs));
+		nr_irqs = n;
+	}
+	return &irqs[irq];
+}
+
+static int is_excluded(unsigned int irq)
+{
+	return irq < nr_excluded && excluded[irq];
+}
+
+static void exclude(unsigned int irq)
+{
+	if (irq >= nr_excluded) {
+		excluded = realloc(excluded, irq + 1);
+		if (!excluded) {
+			perror("realloc");
+			exit(1);
+		}
+		memset(excluded + nr_excluded, 0, irq + 1 - nr_excluded);
+		nr_excluded = irq + 1;
+	}
+	excluded[irq] = 1;
+}
+
+static const char *arg(const char *args, const char *key)
+{
+	const char *p = strstr(args, key);
+
+	return p ? p + strlen(key) : NULL;
+}
+
+/*
+ * Parse one line of ftrace output:
+ *	<comm>-<pid>  [<cpu>] <flags> <seconds>.<us>: <event>: <args>
+ * The flags are only there with the irq-info trace option.
+ */
+static void parse_line(char *line)
+{
+	char *p, *colon, *name, *args, *space;
+	unsigned int state, irq;
+	struct event ev;
+	double ts;
+
+	if (line[0] == '#')
+		return;
+	memset(&ev, 0, sizeof(ev));
+
+	p = strstr(line, "[");
+	if (!p || sscanf(p, "[%u]", &ev.cpu) != 1)
+		return;
+
+	/* the timestamp is the first field ending in ':' after the CPU */
+	p = strchr(p, ']') + 1;
+	for (;;) {
+		while (isspace(*p))
+			p++;
+		if (!*p)
+			return;
+		colon = strchr(p, ':');
+		if (!colon)
+			return;
+		space = strpbrk(p, " \t\n");
+		if (isdigit(*p) && (!space || colon < space)) {
+			ts = strtod(p, NULL);
+			break;
+		}
+		p += strcspn(p, " \t\n");
+	}
+	ev.ts = (unsigned long long)(ts * 1000000.0 + 0.5);
+
+	name = colon + 1;
+	while (isspace(*name))
+		name++;
+	args = strchr(name, ':');
+	if (!args)
+		return;
+	*args++ = '\0';
+
+	if (!strcmp(name, "irq_handler_entry")) {
+		p = (char *)arg(args, "irq=");
+		if (!p || sscanf(p, "%u", &irq) != 1)
+			return;
+		p = (char *)arg(args, "name=");
+		if (p && strstr(p, "timer"))
+			exclude(irq);
+		ev.type = EV_IRQ;
+		ev.irq = irq;
+		add_event(&ev);
+	} else if (!strcmp(name, "cpu_idle_predict")) {
+		if (sscanf(args, " cpu_id=%u state=%u timer_us=%u irq_us=%u measured_us=%u",
+			   &ev.cpu, &state, &ev.timer_us, &ev.irq_us,
+			   &ev.measured_us) != 5)
+			return;
+		ev.type = EV_IDLE;
+		add_event(&ev);
+	}
+}
+
+/* Same as irq_timings_handled() and irq_timings_remember() */
+static void replay_irq(const struct event *ev)
+{
+	struct irq_model *m = irq_model(ev->irq);
+	struct slot *s = slots;
+	unsigned int i;
+
+	/* handlers of a shared interrupt are traced one by one */
+	if (m->last == ev->ts)
+		return;
+
+	if (m->last) {
+		long long diff = ev->ts - m->last - m->interval;
+
+		m->interval += diff / (1 << weight_shift);
+	}
+	m->last = ev->ts;
+
+	if (ev->cpu != cpu || is_excluded(ev->irq))
+		return;
+
+	for (i = 0; i < nr_slots; i++) {
+		if (slots[i].irq == ev->irq && slots[i].last) {
+			s = &slots[i];
+			break;
+		}
+		if (slots[i].last < s->last)
+			s = &slots[i];
+	}
+	s->irq = ev->irq;
+	s->last = m->last;
+	s->interval = m->interval;
+}
+
+/* Same as irq_timings_next_event(), in us from @now */
+static unsigned int predict_irq(unsigned long long now)
+{
+	unsigned long long next, next_event = ULLONG_MAX;
+	unsigned int i;
+
+	for (i = 0; i < nr_slots; i++) {
+		unsigned long long interval = slots[i].interval;
+		unsigned long long since = now - slots[i].last;
+
+		if (!slots[i].last || !interval || slots[i].last > now ||
+		    since > interval * stale)
+			continue;
+
+		next = slots[i].last + interval;
+		if (next <= now)
+			next += since / interval * interval;
+		if (next < next_event)
+			next_event = next;
+	}
+
+	if (next_event - now > UINT_MAX)
+		return UINT_MAX;
+	return next_event - now;
+}
+
+/* The deepest state that pays off when idle for @us */
+static unsigned int state_for(unsigned int us)
+{
+	unsigned int i, state = 0;
+
+	for (i = 0; i < nr_states; i++)
+		if (residency[i] <= us)
+			state = i;
+	return state;
+}
+
+static void account(struct stats *st, unsigned int predicted,
+		    unsigned int measured)
+{
+	long long err = (long long)predicted - measured;
+	unsigned int want, got;
+
+	st->n++;
+	st->abs_err += err < 0 ? -err : err;
+	if (4 * (err < 0 ? -err : err) <= measured)
+		st->close++;
+	else if (err > 0)
+		st->longer++;
+	else
+		st->shorter++;
+
+	if (!nr_states)
+		return;
+	want = state_for(measured);
+	got = state_for(predicted);
+	if (got == want)
+		st->right++;
+	else if (got > want)
+		st->deeper++;
+	else
+		st->shallower++;
+}
+
+static void report(const struct stats *st)
+{
+	double n = st->n ? st->n : 1;
+
+	printf("%-8s %8lu %10.0f %8.1f%% %8.1f%% %8.1f%%",
+	       st->name, st->n, st->abs_err / n, 100.0 * st->close / n,
+	       100.0 * st->longer / n, 100.0 * st->shorter / n);
+	if (nr_states)
+		printf(" %8.1f%% %8.1f%% %8.1f%%", 100.0 * st->right / n,
+		       100.0 * st->deeper / n, 100.0 * st->shallower / n);
+	printf("\n");
+}
+
+static void parse_list(char *list, void (*fn)(unsigned int))
+{
+	char *tok, *end;
+
+	for (tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+		unsigned long v = strtoul(tok, &end, 0);
+
+		if (*end || v > UINT_MAX) {
+			fprintf(stderr, "bad number '%s'\n", tok);
+			exit(1);
+		}
+		fn(v);
+	}
+}
+
+static void add_state(unsigned int us)
+{
+	if (nr_states == MAX_STATES) {
+		fprintf(stderr, "at most %d states\n", MAX_STATES);
+		exit(1);
+	}
+	residency[nr_states++] = us;
+}
+
+int main(int argc, char **argv)
+{
+	struct stats timer = { "timer" }, kernel = { "kernel" }, model = { "model" };
+	unsigned long i, next_irq = 0;
+	char line[4096];
+	FILE *f;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "c:n:s:w:r:x:")) != -1) {
+		switch (opt) {
+		case 'c':
+			cpu = atoi(optarg);
+			break;
+		case 'n':
+			nr_slots = atoi(optarg);
+			if (!nr_slots || nr_slots > MAX_SLOTS)
+				usage(argv[0]);
+			break;
+		case 's':
+			stale = atoi(optarg);
+			break;
+		case 'w':
+			weight_shift = atoi(optarg);
+			if (weight_shift > 16)
+				usage(argv[0]);
+			break;
+		case 'r':
+			parse_list(optarg, add_state);
+			break;
+		case 'x':
+			parse_list(optarg, exclude);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind != argc - 1)
+		usage(argv[0]);
+
+	f = strcmp(argv[optind], "-") ? fopen(argv[optind], "r") : stdin;
+	if (!f) {
+		fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+		return 1;
+	}
+	while (fgets(line, sizeof(line), f))
+		parse_line(line);
+	fclose(f);
+
+	/*
+	 * cpu_idle_predict is traced when the CPU is back from idle, after
+	 * the interrupt that woke it: replay the interrupts up to the time
+	 * the CPU went idle before predicting.
+	 */
+	for (i = 0; i < nr_events; i++) {
+		const struct event *ev = &events[i];
+		unsigned long long entry;
+		unsigned int predicted;
+
+		if (ev->type != EV_IDLE || ev->cpu != cpu)
+			continue;
+
+		if (ev->ts < ev->measured_us)
+			continue;
+		entry = ev->ts - ev->measured_us;
+		for (; next_irq < nr_events; next_irq++) {
+			if (events[next_irq].ts >= entry)
+				break;
+			if (events[next_irq].type == EV_IRQ)
+				replay_irq(&events[next_irq]);
+		}
+
+		account(&timer, ev->timer_us, ev->measured_us);
+		account(&kernel, ev->irq_us < ev->timer_us ?
+			ev->irq_us : ev->timer_us, ev->measured_us);
+		predicted = predict_irq(entry);
+		account(&model, predicted < ev->timer_us ?
+			predicted : ev->timer_us, ev->measured_us);
+	}
+
+	if (!timer.n) {
+		fprintf(stderr, "no cpu_idle_predict events for CPU %u\n", cpu);
+		return 1;
+	}
+
+	printf("%-8s %8s %10s %9s %9s %9s", "", "periods", "mean err",
+	       "within", "longer", "shorter");
+	if (nr_states)
+		printf(" %9s %9s %9s", "state ok", "deeper", "shallower");
+	printf("\n%-8s %8s %10s %9s\n", "", "", "(us)", "25%");
+	report(&timer);
+	report(&kernel);
+	report(&model);
+
+	return 0;
+}
@@ -0,0 +1,334 @@
+/* vDSO vs. syscall check and benchmark
+ *		(C) Copyright 2015
+ *		Licensed under the GPLv2
+ *
+ *  For each of clock_gettime(), clock_getres(), gettimeofday() and
+ *  time() that the vDSO exports, check that it agrees with the system
+ *  call and compare how long a call of each takes.  The vDSO is looked
+ *  up directly, so this doesn't depend on the C library using it.
+ *
+ *  To build:
+ *	$ gcc vdso-bench.c -o vdso-bench -lrt
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <elf.h>
+#include <link.h>
+#include <sys/auxv.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#ifdef KTEST
+#include "../kselftest.h"
+#else
+static inline int ksft_exit_pass(void)
+{
+	exit(0);
+}
+static inline int ksft_exit_fail(void)
+{
+	exit(1);
+}
+#endif
+
+#define NSEC_PER_SEC 1000000000LL
+#define ITERATIONS 1000000
+
+#ifndef CLOCK_MONOTONIC_RAW
+#define CLOCK_MONOTONIC_RAW		4
+#define CLOCK_REALTIME_COARSE		5
+#define CLOCK_MONOTONIC_COARSE		6
+#define CLOCK_BOOTTIME			7
+#endif
+
+typedef int (*clock_fn_t)(clockid_t, struct timespec *);
+typedef int (*gtod_fn_t)(struct timeval *, struct timezone *);
+typedef time_t (*time_fn_t)(time_t *);
+
+static clock_fn_t vdso_clock_gettime;
+static clock_fn_t vdso_clock_getres;
+static gtod_fn_t vdso_gettimeofday;
+static time_fn_t vdso_time;
+
+static const int clocks[] = {
+	CLOCK_REALTIME, CLOCK_MONOTONIC, CLOCK_MONOTONIC_RAW,
+	CLOCK_REALTIME_COARSE, CLOCK_MONOTONIC_COARSE, CLOCK_BOOTTIME,
+};
+
+static const char *clockstring(int clockid)
+{
+	switch (clockid) {
+	case CLOCK_REALTIME:
+		return "CLOCK_REALTIME";
+	case CLOCK_MONOTONIC:
+		return "CLOCK_MONOTONIC";
+	case CLOCK_MONOTONIC_RAW:
+		return "CLOCK_MONOTONIC_RAW";
+	case CLOCK_REALTIME_COARSE:
+		return "CLOCK_REALTIME_COARSE";
+	case CLOCK_MONOTONIC_COARSE:
+		return "CLOCK_MONOTONIC_COARSE";
+	case CLOCK_BOOTTIME:
+		return "CLOCK_BOOTTIME";
+	};
+	return "UNKNOWN_CLOCKID";
+}
+
+/* Find a symbol in the vDSO through its section headers */
+static void *vdso_sym(const char *name)
+{
+	ElfW(Ehdr) *ehdr = (ElfW(Ehdr) *)getauxval(AT_SYSINFO_EHDR);
+	ElfW(Phdr) *phdr;
+	ElfW(Shdr) *shdr;
+	ElfW(Sym) *sym;
+	uintptr_t base = (uintptr_t)ehdr, load = 0;
+	const char *strtab;
+	int i, j;
+
+	if (!ehdr)
+		return NULL;
+
+	phdr = (ElfW(Phdr) *)(base + ehdr->e_phoff);
+	for (i = 0; i < ehdr->e_phnum; i++)
+		if (phdr[i].p_type == PT_LOAD) {
+			load = base + phdr[i].p_offset - phdr[i].p_vaddr;
+			break;
+		}
+
+	shdr = (ElfW(Shdr) *)(base + ehdr->e_shoff);
+	for (i = 0; i < ehdr->e_shnum; i++) {
+		if (shdr[i].sh_type != SHT_DYNSYM)
+			continue;
+
+		sym = (ElfW(Sym) *)(base + shdr[i].sh_offset);
+		strtab = (const char *)(base + shdr[shdr[i].sh_link].sh_offset);
+		for (j = 0; j < shdr[i].sh_size / sizeof(*sym); j++) {
+			/* nulled out symbols have no name */
+			if (!sym[j].st_name || !sym[j].st_shndx)
+				continue;
+			if (!strcmp(strtab + sym[j].st_name, name))
+				return (void *)(load + sym[j].st_value);
+		}
+	}
+
+	return NULL;
+}
+
+static void *lookup(const char *name, const char *alt)
+{
+	void *p = vdso_sym(name);
+
+	return p ? p : vdso_sym(alt);
+}
+
+static long long ts_ns(struct timespec ts)
+{
+	return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static long long now_ns(void)
+{
+	struct timespec ts;
+
+	syscall(SYS_clock_gettime, CLOCK_MONOTONIC, &ts);
+	return ts_ns(ts);
+}
+
+static void report(const char *what, const char *clock, long long sys_ns,
+		   long long vdso_ns)
+{
+	printf("%-14s %-24s syscall %5lld ns  vdso ", what, clock,
+	       sys_ns / ITERATIONS);
+	if (vdso_ns < 0)
+		printf("   -\n");
+	else
+		printf("%5lld ns\n", vdso_ns / ITERATIONS);
+}
+
+static int check_gettime(int clockid)
+{
+	struct timespec before, vdso, after;
+	long long start, sys_ns, vdso_ns = -1;
+	int i;
+
+	if (vdso_clock_gettime) {
+		syscall(SYS_clock_gettime, clockid, &before);
+		if (vdso_clock_gettime(clockid, &vdso))
+			return -1;
+		syscall(SYS_clock_gettime, clockid, &after);
+
+		if (ts_ns(vdso) < ts_ns(before) || ts_ns(vdso) > ts_ns(after)) {
+			printf("%s: vdso %lld not within [%lld, %lld]\n",
+			       clockstring(clockid), ts_ns(vdso),
+			       ts_ns(before), ts_ns(after));
+			return -1;
+		}
+
+		start = now_ns();
+		for (i = 0; i < ITERATIONS; i++)
+			vdso_clock_gettime(clockid, &vdso);
+		vdso_ns = now_ns() - start;
+	}
+
+	start = now_ns();
+	for (i = 0; i < ITERATIONS; i++)
+		syscall(SYS_clock_gettime, clockid, &after);
+	sys_ns = now_ns() - start;
+
+	report("clock_gettime", clockstring(clockid), sys_ns, vdso_ns);
+	return 0;
+}
+
+static int check_getres(int clockid)
+{
+	struct timespec sys, vdso;
+	long long start, sys_ns, vdso_ns = -1;
+	int i;
+
+	if (vdso_clock_getres) {
+		syscall(SYS_clock_getres, clockid, &sys);
+		if (vdso_clock_getres(clockid, &vdso))
+			return -1;
+
+		if (ts_ns(vdso) != ts_ns(sys)) {
+			printf("%s: vdso resolution %lld, syscall %lld\n",
+			       clockstring(clockid), ts_ns(vdso), ts_ns(sys));
+			return -1;
+		}
+
+		start = now_ns();
+		for (i = 0; i < ITERATIONS; i++)
+			vdso_clock_getres(clockid, &vdso);
+		vdso_ns = now_ns() - start;
+	}
+
+	start = now_ns();
+	for (i = 0; i < ITERATIONS; i++)
+		syscall(SYS_clock_getres, clockid, &sys);
+	sys_ns = now_ns() - start;
+
+	report("clock_getres", clockstring(clockid), sys_ns, vdso_ns);
+	return 0;
+}
+
+static int check_gettimeofday(void)
+{
+	struct timeval before, vdso, after;
+	long long start, sys_ns, vdso_ns = -1;
+	int i;
+
+	if (vdso_gettimeofday) {
+		syscall(SYS_gettimeofday, &before, NULL);
+		if (vdso_gettimeofday(&vdso, NULL))
+			return -1;
+		syscall(SYS_gettimeofday, &after, NULL);
+
+		if (timercmp(&vdso, &before, <) || timercmp(&vdso, &after, >)) {
+			printf("gettimeofday: vdso not within syscall results\n");
+			return -1;
+		}
+
+		start = now_ns();
+		for (i = 0; i < ITERATIONS; i++)
+			vdso_gettimeofday(&vdso, NULL);
+		vdso_ns = now_ns() - start;
+	}
+
+	start = now_ns();
+	for (i = 0; i < ITERATIONS; i++)
+		syscall(SYS_gettimeofday, &after, NULL);
+	sys_ns = now_ns() - start;
+
+	report("gettimeofday", "", sys_ns, vdso_ns);
+	return 0;
+}
+
+/* EABI has no time syscall, gettimeofday stands in for it there */
+static time_t sys_time(void)
+{
+#ifdef SYS_time
+	return syscall(SYS_time, NULL);
+#else
+	struct timeval tv;
+
+	syscall(SYS_gettimeofday, &tv, NULL);
+	return tv.tv_sec;
+#endif
+}
+
+static int check_time(void)
+{
+	long long start, sys_ns, vdso_ns = -1;
+	time_t before, vdso, after;
+	int i;
+
+	if (vdso_time) {
+		before = sys_time();
+		vdso = vdso_time(NULL);
+		after = sys_time();
+
+		/* time() is tick based and may lag a second boundary */
+		if (vdso < before - 1 || vdso > after) {
+			printf("time: vdso %ld not within [%ld, %ld]\n",
+			       (long)vdso, (long)before, (long)after);
+			return -1;
+		}
+
+		start = now_ns();
+		for (i = 0; i < ITERATIONS; i++)
+			vdso_time(NULL);
+		vdso_ns = now_ns() - start;
+	}
+
+	start = now_ns();
+	for (i = 0; i < ITERATIONS; i++)
+		sys_time();
+	sys_ns = now_ns() - start;
+
+	report("time", "", sys_ns, vdso_ns);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int i, ret = 0;
+
+	vdso_clock_gettime = lookup("__vdso_clock_gettime",
+				    "__kernel_clock_gettime");
+	vdso_clock_getres = lookup("__vdso_clock_getres",
+				   "__kernel_clock_getres");
+	vdso_gettimeofday = lookup("__vdso_gettimeofday",
+				   "__kernel_gettimeofday");
+	vdso_time = lookup("__vdso_time", "__kernel_time");
+
+	if (!vdso_clock_gettime && !vdso_clock_getres && !vdso_gettimeofday &&
+	    !vdso_time)
+		printf("No vDSO functions found, timing system calls only\n");
+
+	for (i = 0; i < sizeof(clocks) / sizeof(clocks[0]); i++) {
+		ret |= check_gettime(clocks[i]);
+		ret |= check_getres(clocks[i]);
+	}
+	ret |= check_gettimeofday();
+	ret |= check_time();
+
+	if (ret) {
+		printf("[FAILED]\n");
+		return ksft_exit_fail();
+	}
+	printf("[OK]\n");
+	return ksft_exit_pass();
+}